@@ -0,0 +1,633 @@
+/**
+ * @file
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <ctime>
+#include <limits>
+
+#include <TF1.h>
+
+#include "IModel.h"
+#include "ParametricModelPopulation.h"
+#include "CompiledModelPopulation.h"
+#include "Chi2FitFigureOfMerit.h"
+#include "CompiledChi2Fitness.h"
+#include "StaticGeneticAlgorithm.h"
+#include "optparse.h"
+
+void parseCommandLine(Config &config, int argc, char **argv);
+
+/**
+ * @defgroup benchStages Stage Benchmarks
+ *
+ * @brief Microbenchmarks of the stages of a generation.
+ *
+ * @b Objective: Measure in isolation the cost of ranking (IPopulation::sort()), parent selection
+ * (IPopulation::selectParents()), cross-over (ParametricModelPopulation::doCrossOver()), mutation
+ * (ParametricModelPopulation::doMutate()) and scoring (Chi2FitFigureOfMerit::evaluate() and
+ * Chi2FitFigureOfMerit::evaluateBatch()), across population sizes, parameter counts and dataset sizes.
+ * Whole generations of compiled polynomials are also measured through the interfaces (GeneticAlgorithm
+ * with a CompiledModelPopulation) and with the templated algorithm (StaticGeneticAlgorithm), to measure
+ * the cost of the virtual calls.
+ *
+ * Each benchmark repeats its stage until a minimum time is reached, and reports the average time per
+ * iteration and the number of items (individuals or data points) processed per second. Results are
+ * printed as a table, or written as CSV or JSON to track regressions across releases.
+ * The whole suite is run with `make bench`.
+ *
+ * @{
+ */
+
+/**
+ * @brief Parameters of a benchmark.
+ */
+struct BenchArgs {
+  int population; //!< Number of individuals.
+  int npar; //!< Number of parameters of the models.
+  int ndata; //!< Number of data points.
+  ParametricModelPopulation::GenomeStorage storage; //!< Genome storage mode of the population.
+};
+
+/**
+ * @brief Controls the timing loop of a benchmark.
+ *
+ * The benchmarked code runs in a `while(state.keepRunning())` loop. Setup code inside the loop
+ * can be excluded from the measurement with pauseTiming() and resumeTiming().
+ */
+class BenchState {
+
+public:
+
+  /** Constructor. */
+  BenchState(double minTime, int minIterations)
+    : m_minTime(minTime), m_minIterations(minIterations), m_iterations(-1), m_elapsed(0), m_items(0) {}
+
+  /** Returns whether another iteration should be run. */
+  bool keepRunning() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if(m_iterations >= 0) {
+      m_elapsed += std::chrono::duration<double>(now - m_start).count();
+    }
+    m_iterations++;
+    if(m_iterations >= m_minIterations && m_elapsed >= m_minTime) return false;
+    m_start = std::chrono::steady_clock::now();
+    return true;
+  }
+
+  /** Stops the timer until resumeTiming() is called. */
+  void pauseTiming() {
+    m_elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+  }
+
+  /** Restarts the timer. */
+  void resumeTiming() {
+    m_start = std::chrono::steady_clock::now();
+  }
+
+  /** Sets the number of items processed by each iteration. */
+  void setItemsPerIteration(long items) { m_items = items; }
+
+  /** Returns the number of iterations run. */
+  long getIterations() const { return m_iterations; }
+
+  /** Returns the average time per iteration in nanoseconds. */
+  double getTimePerIteration() const { return m_iterations > 0 ? 1e9*m_elapsed/m_iterations : 0; }
+
+  /** Returns the number of items processed per second. */
+  double getItemsPerSecond() const { return m_elapsed > 0 ? m_items*m_iterations/m_elapsed : 0; }
+
+private:
+
+  double m_minTime; //!< Stores the minimum measured time in seconds.
+  int m_minIterations; //!< Stores the minimum number of iterations.
+  long m_iterations; //!< Stores the number of iterations run so far.
+  double m_elapsed; //!< Stores the measured time in seconds.
+  long m_items; //!< Stores the number of items processed by each iteration.
+  std::chrono::steady_clock::time_point m_start; //!< Stores the start of the current measurement.
+};
+
+/**
+ * @brief Population of parametric models exposing the stages of a generation.
+ */
+class BenchPopulation : public ParametricModelPopulation {
+
+public:
+
+  /** Assigns random scores to all individuals, invalidating the ranking. */
+  void shuffle() {
+    m_generation++;
+    RandomStream random = getRandomStream(0, RandomStream::kUser);
+    for(int i=0; i<size(); i++) {
+      m_individuals[i]->setScore(random.Uniform(0, 1000));
+    }
+    m_nRanked = 0;
+  }
+
+  /** Ranks the whole population. */
+  void rank() {
+    sort();
+  }
+
+  /** Ranks the population and stores the scores of the parents, as done before cross-over. */
+  void prepareParents() {
+    sort();
+    for(int i=0; i<size(); i++) {
+      m_parentScores[i] = m_individuals[i]->getScore();
+      m_copies[i] = -1;
+    }
+    m_parents[0] = 0;
+    m_parents[1] = -1;
+  }
+
+  /** Selects the parents of a whole generation. */
+  void select() {
+    selectParents(size()-1, &m_parents[2]);
+  }
+
+  /** Crosses-over the selected parents to produce a whole generation. */
+  void crossOverAll() {
+    doCrossOver(m_parents, 0, size());
+  }
+
+  /** Mutates all individuals. */
+  void mutateAll() {
+    m_generation++;
+    for(int i=0; i<size(); i++) {
+      RandomStream random = getRandomStream(i, RandomStream::kMutation);
+      doMutate(m_individuals[i], random);
+    }
+  }
+
+  /** Returns the individuals. */
+  IModel *const *getIndividuals() {
+    return &m_individuals[0];
+  }
+};
+
+/**
+ * @brief Compiled polynomial of degree N-1, equivalent to ROOT's "polN-1" formula.
+ */
+template<int N>
+struct Polynomial {
+  static const int kNpar = N; //!< Coefficients of the polynomial.
+  static const int kNdim = 1; //!< Function of x only.
+  double operator()(const double *x, const double *p) const {
+    double value = p[N-1];
+    for(int i=N-2; i>=0; i--) value = value*x[0] + p[i];
+    return value;
+  }
+};
+
+/**
+ * @brief Fills a figure of merit with a noisy parabola sampled in [-1, 1].
+ *
+ * @param fom Figure of merit receiving the data.
+ * @param ndata Number of data points.
+ */
+void fillBenchData(Chi2FitFigureOfMerit &fom, int ndata)
+{
+  RandomStream random(1234);
+  std::vector<double> x(1);
+  for(int i=0; i<ndata; i++) {
+    x[0] = -1 + 2.*(i+0.5)/ndata;
+    fom.addData(x, x[0]*x[0] + random.Gaus(0, 0.01), 0.01);
+  }
+}
+
+/**
+ * @brief Data set, formula and population used by a benchmark.
+ */
+struct BenchFixture {
+
+  /** Builds a population of polynomials of degree npar-1 and a dataset of ndata points. */
+  BenchFixture(const BenchArgs &args)
+  {
+    fillBenchData(fom, args.ndata);
+
+    std::ostringstream ostr;
+    ostr << "pol" << args.npar-1;
+    formula = new TF1("benchFormula", ostr.str().c_str(), -1, 1);
+    for(int p=0; p<args.npar; p++) {
+      formula->SetParLimits(p, -1, 1);
+    }
+
+    population.setFigureOfMerit(&fom);
+    population.setFormula(formula);
+    population.setGenomeStorage(args.storage);
+    population.setMutateRate(1);
+    population.initialize(args.population);
+    population.shuffle();
+  }
+
+  /** Destructor. */
+  ~BenchFixture()
+  {
+    population.clear();
+    delete formula;
+  }
+
+  Chi2FitFigureOfMerit fom; //!< Figure of merit holding the dataset.
+  TF1 *formula; //!< Formula of the models.
+  BenchPopulation population; //!< Population of models.
+};
+
+/** @brief Benchmarks the ranking of a population with random scores. */
+void benchSort(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  state.setItemsPerIteration(args.population);
+  while(state.keepRunning()) {
+    state.pauseTiming();
+    fixture.population.shuffle();
+    state.resumeTiming();
+    fixture.population.rank();
+  }
+}
+
+/** @brief Benchmarks the selection of the parents of a whole generation. */
+void benchSelectParents(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  fixture.population.prepareParents();
+  state.setItemsPerIteration(args.population);
+  while(state.keepRunning()) {
+    fixture.population.select();
+  }
+}
+
+/** @brief Benchmarks the cross-over of a whole generation. */
+void benchCrossOver(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  fixture.population.prepareParents();
+  fixture.population.select();
+  state.setItemsPerIteration(args.population);
+  while(state.keepRunning()) {
+    fixture.population.crossOverAll();
+  }
+}
+
+/** @brief Benchmarks the mutation of a whole generation. */
+void benchMutate(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  state.setItemsPerIteration(args.population);
+  while(state.keepRunning()) {
+    fixture.population.mutateAll();
+  }
+}
+
+/** @brief Benchmarks the evaluation of the models one at a time. */
+void benchEvaluate(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  IModel *const *models = fixture.population.getIndividuals();
+  state.setItemsPerIteration((long)args.population*args.ndata);
+  double sum = 0;
+  while(state.keepRunning()) {
+    for(int i=0; i<args.population; i++) {
+      sum += fixture.fom.evaluate(models[i]);
+    }
+  }
+  if(sum == -1) std::cout << sum << std::endl; // keeps the evaluation from being optimized away
+}
+
+/** @brief Benchmarks the evaluation of the models in a single batch. */
+void benchEvaluateBatch(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  IModel *const *models = fixture.population.getIndividuals();
+  std::vector<double> scores(args.population);
+  state.setItemsPerIteration((long)args.population*args.ndata);
+  while(state.keepRunning()) {
+    fixture.fom.evaluateBatch(models, args.population, &scores[0]);
+  }
+}
+
+/** @brief Benchmarks whole generations of a population of compiled polynomials of N parameters. */
+template<int N>
+void benchCompiledGeneration(BenchState &state, const BenchArgs &args)
+{
+  BenchFixture fixture(args);
+  CompiledModelPopulation<Polynomial<N> > population;
+  population.setFigureOfMerit(&fixture.fom);
+  population.setFormula(fixture.formula);
+  population.setGenomeStorage(args.storage);
+  population.initialize(args.population);
+  population.score();
+  state.setItemsPerIteration(args.population);
+  while(state.keepRunning()) {
+    population.crossOver();
+    population.mutate();
+    population.score();
+  }
+}
+
+/** @brief Benchmarks whole generations of the templated algorithm fitting compiled polynomials of N parameters. */
+template<int N>
+void benchStaticGeneration(BenchState &state, const BenchArgs &args)
+{
+  typedef CompiledChi2Fitness<Polynomial<N> > Fitness;
+  typedef typename Fitness::Genome Genome;
+
+  Fitness fitness;
+  fillBenchData(fitness, args.ndata);
+  Genome initial;
+  Genome parMin;
+  Genome parMax;
+  for(int p=0; p<N; p++) {
+    initial[p] = 0;
+    parMin[p] = -1;
+    parMax[p] = 1;
+  }
+
+  StaticGeneticAlgorithm<Genome, Fitness> alg;
+  alg.setFitness(&fitness);
+  alg.setPopulationSize(args.population);
+  alg.setNGenerationsMax(std::numeric_limits<int>::max());
+  alg.setMutation(GaussianMutation<Genome>(parMin, parMax));
+  alg.initialize(UniformInitializer<Genome>(initial, parMin, parMax));
+  state.setItemsPerIteration(args.population);
+  while(state.keepRunning()) {
+    alg.nextGeneration();
+  }
+}
+
+/**
+ * @brief Benchmark registered in the suite.
+ */
+struct Benchmark {
+  std::string stage; //!< Name of the benchmarked stage.
+  void (*function)(BenchState &, const BenchArgs &); //!< Function running the benchmark.
+  BenchArgs args; //!< Parameters of the benchmark.
+
+  /** Returns the name of the benchmark, identifying the stage and its parameters. */
+  std::string getName() const {
+    std::ostringstream ostr;
+    ostr << stage
+	 << "/" << (args.storage == ParametricModelPopulation::kFlatBuffer ? "flat" : "clones")
+	 << "/population:" << args.population
+	 << "/npar:" << args.npar
+	 << "/ndata:" << args.ndata;
+    return ostr.str();
+  }
+};
+
+/**
+ * @brief Result of a benchmark.
+ */
+struct BenchResult {
+  const Benchmark *benchmark; //!< The benchmark.
+  long iterations; //!< Number of iterations run.
+  double time; //!< Average time per iteration in nanoseconds.
+  double itemsPerSecond; //!< Number of items processed per second.
+};
+
+/**
+ * @brief Registers the benchmarks of the suite.
+ *
+ * Ranking and selection are measured against the population size, cross-over and mutation against
+ * the population size and the number of parameters for both genome storage modes, whole generations against
+ * the population size and the number of parameters, and scoring against the number of parameters and the dataset size.
+ *
+ * @param benchmarks List to fill.
+ */
+void registerBenchmarks(std::vector<Benchmark> &benchmarks)
+{
+  const ParametricModelPopulation::GenomeStorage flat = ParametricModelPopulation::kFlatBuffer;
+  const ParametricModelPopulation::GenomeStorage clones = ParametricModelPopulation::kFormulaClones;
+
+  int populations[] = {1000, 10000, 100000};
+  for(int i=0; i<3; i++) {
+    BenchArgs args = {populations[i], 3, 10, flat};
+    Benchmark sortBench = {"sort", benchSort, args};
+    benchmarks.push_back(sortBench);
+    Benchmark selectBench = {"selectParents", benchSelectParents, args};
+    benchmarks.push_back(selectBench);
+  }
+
+  int breedPopulations[] = {1000, 10000};
+  int npars[] = {3, 10, 30};
+  for(int s=0; s<2; s++) {
+    for(int i=0; i<2; i++) {
+      for(int p=0; p<3; p++) {
+	BenchArgs args = {breedPopulations[i], npars[p], 10, s ? clones : flat};
+	Benchmark crossOverBench = {"doCrossOver", benchCrossOver, args};
+	benchmarks.push_back(crossOverBench);
+	Benchmark mutateBench = {"doMutate", benchMutate, args};
+	benchmarks.push_back(mutateBench);
+      }
+    }
+  }
+
+  void (*compiledGenerations[])(BenchState &, const BenchArgs &) = {
+    benchCompiledGeneration<3>, benchCompiledGeneration<10>, benchCompiledGeneration<30>
+  };
+  void (*staticGenerations[])(BenchState &, const BenchArgs &) = {
+    benchStaticGeneration<3>, benchStaticGeneration<10>, benchStaticGeneration<30>
+  };
+  for(int i=0; i<2; i++) {
+    for(int p=0; p<3; p++) {
+      BenchArgs args = {breedPopulations[i], npars[p], 100, flat};
+      Benchmark compiledBench = {"compiledGeneration", compiledGenerations[p], args};
+      benchmarks.push_back(compiledBench);
+      Benchmark staticBench = {"staticGeneration", staticGenerations[p], args};
+      benchmarks.push_back(staticBench);
+    }
+  }
+
+  int ndatas[] = {100, 1000, 10000};
+  for(int d=0; d<3; d++) {
+    for(int p=0; p<3; p++) {
+      BenchArgs args = {64, npars[p], ndatas[d], flat};
+      Benchmark evaluateBench = {"evaluate", benchEvaluate, args};
+      benchmarks.push_back(evaluateBench);
+      Benchmark batchBench = {"evaluateBatch", benchEvaluateBatch, args};
+      benchmarks.push_back(batchBench);
+    }
+  }
+}
+
+/**
+ * @brief Writes the results as a human readable table.
+ *
+ * @param out Output stream.
+ * @param results Results of the benchmarks.
+ */
+void writeTable(std::ostream &out, const std::vector<BenchResult> &results)
+{
+  out << std::left << std::setw(56) << "benchmark" << std::right
+      << std::setw(14) << "time [ns]"
+      << std::setw(14) << "iterations"
+      << std::setw(16) << "items/s" << std::endl;
+  for(unsigned int i=0; i<results.size(); i++) {
+    out << std::left << std::setw(56) << results[i].benchmark->getName() << std::right
+	<< std::setw(14) << results[i].time
+	<< std::setw(14) << results[i].iterations
+	<< std::setw(16) << results[i].itemsPerSecond << std::endl;
+  }
+}
+
+/**
+ * @brief Writes the results as CSV, one line per benchmark.
+ *
+ * @param out Output stream.
+ * @param results Results of the benchmarks.
+ */
+void writeCSV(std::ostream &out, const std::vector<BenchResult> &results)
+{
+  out << "name,stage,storage,population,npar,ndata,iterations,real_time_ns,items_per_second" << std::endl;
+  for(unsigned int i=0; i<results.size(); i++) {
+    const Benchmark *bench = results[i].benchmark;
+    out << bench->getName() << ","
+	<< bench->stage << ","
+	<< (bench->args.storage == ParametricModelPopulation::kFlatBuffer ? "flat" : "clones") << ","
+	<< bench->args.population << ","
+	<< bench->args.npar << ","
+	<< bench->args.ndata << ","
+	<< results[i].iterations << ","
+	<< results[i].time << ","
+	<< results[i].itemsPerSecond << std::endl;
+  }
+}
+
+/**
+ * @brief Writes the results as JSON, following the layout of the Google Benchmark reports.
+ *
+ * @param out Output stream.
+ * @param results Results of the benchmarks.
+ */
+void writeJSON(std::ostream &out, const std::vector<BenchResult> &results)
+{
+  char date[64];
+  std::time_t now = std::time(0);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  out << "{" << std::endl
+      << "  \"context\": {" << std::endl
+      << "    \"date\": \"" << date << "\"," << std::endl
+      << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl
+      << "    \"library\": \"GeneticAlgoithm\"" << std::endl
+      << "  }," << std::endl
+      << "  \"benchmarks\": [" << std::endl;
+  for(unsigned int i=0; i<results.size(); i++) {
+    const Benchmark *bench = results[i].benchmark;
+    out << "    {" << std::endl
+	<< "      \"name\": \"" << bench->getName() << "\"," << std::endl
+	<< "      \"stage\": \"" << bench->stage << "\"," << std::endl
+	<< "      \"storage\": \"" << (bench->args.storage == ParametricModelPopulation::kFlatBuffer ? "flat" : "clones") << "\"," << std::endl
+	<< "      \"population\": " << bench->args.population << "," << std::endl
+	<< "      \"npar\": " << bench->args.npar << "," << std::endl
+	<< "      \"ndata\": " << bench->args.ndata << "," << std::endl
+	<< "      \"iterations\": " << results[i].iterations << "," << std::endl
+	<< "      \"real_time\": " << results[i].time << "," << std::endl
+	<< "      \"time_unit\": \"ns\"," << std::endl
+	<< "      \"items_per_second\": " << results[i].itemsPerSecond << std::endl
+	<< "    }" << (i+1 < results.size() ? "," : "") << std::endl;
+  }
+  out << "  ]" << std::endl
+      << "}" << std::endl;
+}
+
+/**
+ * @brief Main function
+ *
+ * Runs the benchmarks whose name contains the filter, and writes the results in the requested format.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return 0 upon successfull exit
+ */
+int main(int argc, char **argv) {
+
+  Config config;
+  parseCommandLine(config, argc, argv);
+
+  std::string filter = config.get("filter");
+  std::string format = config.get("format");
+  std::string output = config.get("output");
+  double minTime = config.get("minTime");
+  int minIterations = config.get("minIterations");
+
+  if(format != "table" && format != "csv" && format != "json") {
+    std::cerr << "Unknown output format: " << format << std::endl;
+    return 1;
+  }
+
+  std::vector<Benchmark> benchmarks;
+  registerBenchmarks(benchmarks);
+
+  std::vector<BenchResult> results;
+  for(unsigned int i=0; i<benchmarks.size(); i++) {
+    std::string name = benchmarks[i].getName();
+    if(name.find(filter) == std::string::npos) continue;
+    std::cerr << "Running " << name << std::endl;
+    BenchState state(minTime, minIterations);
+    benchmarks[i].function(state, benchmarks[i].args);
+    BenchResult result = {&benchmarks[i], state.getIterations(), state.getTimePerIteration(), state.getItemsPerSecond()};
+    results.push_back(result);
+  }
+
+  std::ofstream file;
+  if(!output.empty()) {
+    file.open(output.c_str());
+    if(!file) {
+      std::cerr << "Cannot open output file: " << output << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &out = output.empty() ? std::cout : file;
+
+  if(format == "csv") writeCSV(out, results);
+  else if(format == "json") writeJSON(out, results);
+  else writeTable(out, results);
+
+  return 0;
+}
+
+/**
+ * @brief Prase command line arguments.
+ *
+ * @param config Configuration to parse into.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ *
+ * #### Configuration details:
+ */
+void parseCommandLine(Config &config, int argc, char **argv)
+{
+
+  optparse::OptionParser parser = optparse::OptionParser().description("Stage Benchmarks");
+
+  /** - @b -f, <b> \-\-format </b> Output format: table, csv or json. */
+  parser.add_option("-f", "--format").action("store").dest("format").set_default("table")
+    .help("Output format: table, csv or json.");
+
+  /** - @b -o, <b> \-\-output </b> Output file (standard output if empty). */
+  parser.add_option("-o", "--output").action("store").dest("output").set_default("")
+    .help("Output file (standard output if empty).");
+
+  /** - @b -b, <b> \-\-filter </b> Only run the benchmarks whose name contains this string. */
+  parser.add_option("-b", "--filter").action("store").dest("filter").set_default("")
+    .help("Only run the benchmarks whose name contains this string.");
+
+  /** - @b -t, <b> \-\-minTime </b> Minimum measured time per benchmark, in seconds. */
+  parser.add_option("-t", "--minTime").action("store").dest("minTime").set_default(0.2)
+    .help("Minimum measured time per benchmark, in seconds.");
+
+  /** - @b -n, <b> \-\-minIterations </b> Minimum number of iterations per benchmark. */
+  parser.add_option("-n", "--minIterations").action("store").dest("minIterations").set_default(3)
+    .help("Minimum number of iterations per benchmark.");
+
+  config = parser.parse_args(argc, argv);
+}
+
+/** @} */
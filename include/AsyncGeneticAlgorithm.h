@@ -0,0 +1,121 @@
+#ifndef ASYNCGENETICALGORITHM_H
+#define ASYNCGENETICALGORITHM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+class IModel;
+class IPopulation;
+class IFigureOfMerit;
+class ITerminationPolicy;
+
+/**
+ * @brief Class implementing an asynchronous steady-state Genetic Algorithm.
+ *
+ * The population evolves in steady state (see IPopulation::breedSteadyState()): each batch of offspring
+ * replaces the least fitted individuals. Instead of waiting for a batch to be scored before breeding the next one,
+ * several batches are kept in flight: while worker threads evaluate the offspring, the calling thread breeds the
+ * next batches. Each iteration waits for any batch to be scored, inserts it into the ranking, then breeds a new batch
+ * to keep the workers busy.
+ *
+ * The offspring in flight are taken out of the population: parents are selected among the remaining individuals,
+ * such that the number of individuals eligible as parents is reduced by the number of offspring in flight.
+ *
+ * If the figure of merit is not thread-safe (see IFigureOfMerit::isThreadSafe()), a single worker is used:
+ * evaluation is then still overlapped with breeding. With a single worker, batches are scored in the order they
+ * are bred and results are reproducible. With several workers, they depend on the order in which batches complete.
+ */
+class AsyncGeneticAlgorithm {
+
+public:
+
+  /** Default Constructor */
+  AsyncGeneticAlgorithm();
+
+  /** Destructor */
+  ~AsyncGeneticAlgorithm();
+
+  /** Finds the best solution given a population of models. */
+  IModel *optimize(IPopulation *population);
+
+  /** Initialize the algorithm and fills the pipeline before the optimization loop starts. */
+  void initialize(IPopulation *population);
+
+  /** Waits for a batch of offspring to be scored, inserts it in the population and breeds a new batch. */
+  bool nextGeneration();
+
+  /** Waits for all batches in flight and inserts them in the population. */
+  void finish();
+
+  /** Returns the current iteration number. */
+  int getCurrentGeneration();
+
+  /** Sets the maximum number of iterations before giving up. */
+  void setNGenerationsMax(int generationsMax);
+
+  /** Sets the population size */
+  void setPopulationSize(int populationSize);
+
+  /** Sets the number of offspring per batch. */
+  void setBatchSize(int batchSize);
+
+  /** Sets the number of batches in flight. */
+  void setNBatches(int nBatches);
+
+  /** Sets the number of threads evaluating the offspring. */
+  void setNWorkers(int nWorkers);
+
+  /** Sets the policy deciding whether to stop the optimization early. */
+  void setTerminationPolicy(ITerminationPolicy *policy);
+
+private:
+
+  /** Batch of offspring being evaluated. */
+  struct Batch {
+    std::vector<IModel*> models; //!< Offspring to be evaluated.
+    std::vector<double> scores; //!< Scores of the offspring.
+    bool done; //!< Whether the offspring have been evaluated.
+  };
+
+  /** Breeds a new batch of offspring and queues it for evaluation. */
+  void submit();
+
+  /** Waits for a batch to be scored and inserts it into the population. */
+  void collect();
+
+  /** Main loop of the worker threads. */
+  void work();
+
+  /** Starts the worker threads. */
+  void startWorkers();
+
+  /** Stops the worker threads. */
+  void stopWorkers();
+
+  int m_generationsMax; //!< Stores the maximum number of iterations.
+  int m_populationSize; //!< Stores the desired population size.
+  int m_currentGeneration; //!< Stores the number of the current iteration.
+  int m_batchSize; //!< Stores the number of offspring per batch.
+  int m_nBatches; //!< Stores the number of batches in flight.
+  int m_nWorkers; //!< Stores the number of threads evaluating the offspring.
+  IPopulation *m_population; //!< Stores a pointer to the population being optimized.
+  IFigureOfMerit *m_fom; //!< Stores the figure of merit used by the workers.
+  ITerminationPolicy *m_terminationPolicy; //!< Stores the policy deciding whether to stop the optimization early, if any.
+  int m_nRanked; //!< Stores the number of individuals of the population that are not in flight.
+  std::vector<Batch> m_batches; //!< Stores the batches.
+  std::vector<Batch*> m_inFlight; //!< Stores the batches in flight, in the order of their position in the population.
+  std::vector<Batch*> m_free; //!< Stores the batches that are not in flight.
+  std::deque<Batch*> m_queue; //!< Stores the batches waiting for a worker.
+  std::vector<std::thread> m_workers; //!< Stores the worker threads.
+  std::mutex m_mutex; //!< Protects the queue and the completion of the batches.
+  std::condition_variable m_wakeUp; //!< Signals the workers that a batch is queued.
+  std::condition_variable m_completed; //!< Signals the calling thread that a batch is scored.
+  bool m_stop; //!< Tells the workers to exit.
+  std::exception_ptr m_error; //!< Stores the first exception thrown by the evaluation.
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef BATCHFITTER_H
+#define BATCHFITTER_H
+
+#include <vector>
+#include <mutex>
+#include <ostream>
+
+#include "Chi2FitFigureOfMerit.h"
+#include "ParametricModelPopulation.h"
+#include "GeneticAlgorithm.h"
+#include "StallTermination.h"
+
+class TF1;
+class ThreadPool;
+
+/**
+ * @brief Fits a model definition to many independent datasets.
+ *
+ * Each dataset is fitted with its own \f$\chi^2\f$ figure of merit, population and genetic algorithm, as done
+ * by runGA for a single histogram. The fits are scheduled over a pool of threads (see setNThreads()): each thread
+ * takes the next fit as soon as it is done with the previous one, such that fits of different durations
+ * are balanced across threads.
+ *
+ * Each thread owns a fitting context (figure of merit, population in kFlatBuffer mode, algorithm and clone of
+ * the formula) that is reused from one fit to the next: after the first fit, the data and model buffers are
+ * recycled and fitting a dataset does not create ROOT objects.
+ *
+ * The random seed of each fit is derived from its index, such that the results do not depend on the number
+ * of threads nor on the order in which fits are scheduled.
+ */
+class BatchFitter {
+
+public:
+
+  /** Result of the fit of a dataset. */
+  struct Result {
+    std::vector<double> parameters; //!< Parameters of the best fitted model.
+    double score; //!< Score of the best fitted model.
+    int generations; //!< Number of generations evolved.
+    long nEvaluations; //!< Number of evaluations of the figure of merit.
+    double time; //!< Wall-clock time of the fit in seconds.
+    bool failed; //!< Whether the fit threw an exception.
+
+    /** Constructor */
+    Result() : score(0), generations(0), nEvaluations(0), time(0), failed(false) {}
+  };
+
+  /** Default Constructor */
+  BatchFitter();
+
+  /** Destructor */
+  ~BatchFitter();
+
+  /** Sets the model definition shared by all fits. */
+  void setFormula(TF1 *formula);
+
+  /** Adds a dataset to be fitted. */
+  int addDataset(int n, const double *x, const double *y, const double *ey, int ndim=1);
+
+  /** Removes all datasets and results. */
+  void clearDatasets();
+
+  /** Returns the number of datasets. */
+  int getNDatasets();
+
+  /** Fits all datasets. */
+  void fit();
+
+  /** Returns the result of the fit of a dataset. */
+  const Result &getResult(int i);
+
+  /** Writes the results as a table. */
+  void printResults(std::ostream &out);
+
+  /** Sets the number of fits running concurrently. */
+  void setNThreads(int nThreads);
+
+  /** Sets the population size of each fit. */
+  void setPopulationSize(int populationSize);
+
+  /** Sets the maximum number of generations of each fit. */
+  void setNGenerationsMax(int generationsMax);
+
+  /** Sets the number of generations without improvement after which a fit stops. */
+  void setStallGenerations(int stallGenerations);
+
+  /** Sets the score threshold to accept a model. */
+  void setAcceptThreshold(double acceptThreshold);
+
+  /** Sets the mutation rate. */
+  void setMutateRate(double rate);
+
+  /** Sets the relative size of the mutations. */
+  void setMutationSize(double relativeSize);
+
+  /** Sets the seed from which the seed of each fit is derived. */
+  void setRandomSeed(int seed);
+
+private:
+
+  /** Dataset to be fitted. */
+  struct Dataset {
+    int ndim; //!< Number of dimensions of the points.
+    std::vector<double> x; //!< Coordinates of the points, by columns of one dimension.
+    std::vector<double> y; //!< Values of the points.
+    std::vector<double> ey; //!< Errors on the values of the points.
+  };
+
+  /** Objects needed to perform a fit, reused from one fit to the next. */
+  struct Context {
+    TF1 *formula; //!< Clone of the model definition.
+    Chi2FitFigureOfMerit fom; //!< Figure of merit holding the dataset.
+    ParametricModelPopulation population; //!< Population of models.
+    GeneticAlgorithm algorithm; //!< Algorithm evolving the population.
+    StallTermination *stall; //!< Termination policy, if any.
+  };
+
+  /** Creates the fitting contexts. */
+  void createContexts(int n);
+
+  /** Deletes the fitting contexts. */
+  void deleteContexts();
+
+  /** Fits a dataset using a given context. */
+  void fitDataset(Context *context, int i);
+
+  TF1 *m_formula; //!< Stores the model definition.
+  std::vector<Dataset> m_datasets; //!< Stores the datasets.
+  std::vector<Result> m_results; //!< Stores the results of the fits.
+  std::vector<Context*> m_contexts; //!< Stores the fitting contexts.
+  std::vector<Context*> m_freeContexts; //!< Stores the fitting contexts not in use.
+  std::mutex m_mutex; //!< Protects the fitting contexts not in use.
+  ThreadPool *m_threadPool; //!< Stores the pool of threads running the fits, if any.
+  int m_populationSize; //!< Stores the population size of each fit.
+  int m_generationsMax; //!< Stores the maximum number of generations of each fit.
+  int m_stallGenerations; //!< Stores the number of generations without improvement after which a fit stops (0 to disable).
+  double m_acceptThreshold; //!< Stores the score threshold to accept a model.
+  double m_mutateRate; //!< Stores the mutation rate.
+  double m_mutationSize; //!< Stores the relative size of the mutations.
+  int m_seed; //!< Stores the seed from which the seed of each fit is derived.
+};
+
+#endif
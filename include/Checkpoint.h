@@ -0,0 +1,61 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @brief Snapshot of the state of an optimization, from which it can be resumed.
+ *
+ * A checkpoint holds everything needed to continue an optimization with the same results as if it
+ * had not been interrupted:
+ * - The genomes, scores and out of date flags of the individuals, in their current order.
+ * - The state of the ranking and the moments of the scores.
+ * - The state of the random numbers: since they are drawn from counter-based streams (see RandomStream),
+ * this is the random seed and the number of generations bred by the population.
+ * - The generation counter of the algorithm and the evaluation counters of the population.
+ *
+ * It is filled by IPopulation::saveState() and applied by IPopulation::restoreState(), and can be stored in a
+ * compact binary file (see write() and read()). The file starts with the magic string "GACKPT" and the format
+ * version, followed by the fields in the native byte order, and ends with a checksum of the content.
+ *
+ * The fitness cache (see IPopulation::setFitnessCacheSize()) is not saved: after a restart, scores that were
+ * in the cache are evaluated again, which changes the evaluation counters but not the results.
+ */
+class Checkpoint {
+
+public:
+
+  /** Default Constructor */
+  Checkpoint();
+
+  /** Writes the checkpoint to a file. */
+  void write(const std::string &path) const;
+
+  /** Reads the checkpoint from a file. */
+  void read(const std::string &path);
+
+  /** Version of the file format. */
+  static const uint32_t kVersion = 1;
+
+  int generation; //!< Generation counter of the algorithm.
+  uint64_t seed; //!< Random seed of the population.
+  uint64_t populationGeneration; //!< Number of generations bred by the population, used to derive the random streams.
+  int size; //!< Number of individuals.
+  int genomeSize; //!< Number of values in the genome of each individual.
+  int nRanked; //!< Number of leading individuals whose ranking is valid.
+  bool rankedScoresValid; //!< Whether parentScores holds the scores of the ranked individuals.
+  double scoreSum; //!< Sum of the scores.
+  double scoreSum2; //!< Sum of the squared scores.
+  double scoreMean; //!< Mean of the scores.
+  double scoreRMS; //!< RMS of the scores.
+  int64_t cacheHits; //!< Number of scores that did not need to be evaluated.
+  int64_t cacheMisses; //!< Number of scores that were evaluated.
+  std::vector<double> genomes; //!< Genomes of the individuals, one after the other.
+  std::vector<double> scores; //!< Scores of the individuals.
+  std::vector<char> dirty; //!< Whether the score of each individual is out of date.
+  std::vector<double> parentScores; //!< Scores of the ranked individuals, if rankedScoresValid.
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef CHECKPOINTWRITER_H
+#define CHECKPOINTWRITER_H
+
+#include "Checkpoint.h"
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief Writes checkpoints to a file from a background thread.
+ *
+ * submit() copies the checkpoint and returns immediately: the file is written by a background thread,
+ * such that the optimization loop is not stalled by the disk. If a checkpoint is submitted while the
+ * previous one is still being written, only the most recent pending checkpoint is kept.
+ *
+ * The file always holds a complete checkpoint (see Checkpoint::write()).
+ */
+class CheckpointWriter {
+
+public:
+
+  /** Constructor */
+  CheckpointWriter(const std::string &path);
+
+  /** Destructor */
+  ~CheckpointWriter();
+
+  /** Schedules the writing of a checkpoint. */
+  void submit(const Checkpoint &checkpoint);
+
+  /** Waits until the pending checkpoint is written. */
+  void flush();
+
+  /** Returns the number of checkpoints written. */
+  int getNWritten();
+
+  /** Returns the path of the checkpoint file. */
+  const std::string &getPath() const;
+
+private:
+
+  /** Writes the pending checkpoints until stopped. */
+  void run();
+
+  std::string m_path; //!< Stores the path of the checkpoint file.
+  Checkpoint m_pending; //!< Stores the checkpoint waiting to be written.
+  Checkpoint m_writing; //!< Stores the checkpoint being written.
+  bool m_hasPending; //!< Stores whether a checkpoint is waiting to be written.
+  bool m_busy; //!< Stores whether a checkpoint is being written.
+  bool m_stop; //!< Stores whether the thread should stop.
+  int m_nWritten; //!< Stores the number of checkpoints written.
+  std::string m_error; //!< Stores the error of the last failed write, if any.
+  std::mutex m_mutex; //!< Protects the state shared with the thread.
+  std::condition_variable m_wakeUp; //!< Signals the thread that a checkpoint is pending.
+  std::condition_variable m_done; //!< Signals that a checkpoint was written.
+  std::thread m_thread; //!< Stores the writing thread.
+};
+
+#endif
@@ -6,6 +6,9 @@
 #include <vector>
 
 class IModel;
+class TH1;
+class TGraphErrors;
+class MappedDataset;
 
 /**
  * @brief Class implementing a \f$\chi^2/ndf\f$ figure of merit.
@@ -17,6 +20,19 @@ class IModel;
  * \f[
  * \chi^2/ndf = \frac{1}{N}\sum_{i=0}^N \frac{(y_i - f(\vec{x_i}))^2}{\sigma_{y_i}^2}
  * \f]
+ *
+ * The data is stored by columns: one contiguous array per dimension of \f$\vec{x}\f$, one for \f$y\f$
+ * and one for the precomputed weights \f$1/\sigma_y^2\f$. Models are evaluated on batches of
+ * consecutive points (see ParametricModel::evalBatch()) and the \f$\chi^2\f$ is accumulated
+ * in a tight loop over each batch. When several models are evaluated at once, each batch of points
+ * is evaluated for a block of models before moving to the next, such that the data is read from
+ * memory once per block rather than once per model.
+ *
+ * The columns are accessed through pointers, such that the data can either be owned by this object
+ * (see addData()) or wrapped without copy from memory owned by the caller: raw arrays, the arrays of
+ * a histogram or a graph, or a dataset file mapped in memory (see setData()). The weights are computed on the fly
+ * for each batch of points, such that no column is derived from the errors. Wrapped data must outlive
+ * this object, or be detached with clearData().
  */
 class Chi2FitFigureOfMerit : public IFigureOfMerit {
 
@@ -31,20 +47,66 @@ public:
   /** Adds a data point */
   void addData(const std::vector<double> &x, double y, double ey);
 
+  /** Wraps caller-owned columns of points without copying them. */
+  void setData(int n, int ndim, const double *const *x, const double *y, const double *ey);
+
+  /** Wraps the bin contents and errors of a histogram. */
+  void setData(const TH1 *hist);
+
+  /** Wraps the points and errors of a graph without copying them. */
+  void setData(const TGraphErrors *graph);
+
+  /** Wraps a dataset mapped in memory without copying it. */
+  void setData(const MappedDataset &dataset);
+
+  /** Returns the number of data points. */
+  int getNPoints() const;
+
   /** Clear all data */
   void clearData();
 
   /** Compute the score (\f$\chi^2/ndf\f$) for a given model relative to the data points. */
   double evaluate(IModel *model) const;
 
+  /** Compute the scores for several models at once, sharing the data traversal. */
+  void evaluateBatch(IModel *const *models, int n, double *scores) const;
+
+  /** Returns true: models can be evaluated concurrently. */
+  bool isThreadSafe() const;
+
   /** Compares two score values */
   bool isBetterThan(double scoreToTest, double referenceScore) const;
 
+  /** Number of points per batch of evaluation. */
+  static const int kBatchSize = 256;
+
+  /** Number of models evaluated together on each batch of points by evaluateBatch(). */
+  static const int kModelBlockSize = 16;
+
 protected:
 
-  std::vector<std::vector<double> > m_x; //!< Stores the \f$\vec{x_i}\f$ coordinates.
-  std::vector<double> m_y; //!< Stores the \f$y_i\f$ coordinates.
-  std::vector<double> m_ey; //!< Stores the \f$\sigma_{y_i}\f$ errors.
+  /** Points the columns to the owned data. */
+  void useOwnedData();
+
+  /** Checks the dimensions and counts the points entering the \f$\chi^2\f$. */
+  void setColumns(int n, int ndim);
+
+  /** Computes the weights of a batch of points. */
+  void computeWeights(int begin, int n, double *weight) const;
+
+  int m_npoints; //!< Stores the number of points.
+  std::vector<const double*> m_x; //!< Stores the \f$\vec{x_i}\f$ coordinates, one array per dimension.
+  const double *m_y; //!< Stores the \f$y_i\f$ coordinates.
+  const double *m_error; //!< Stores the errors \f$\sigma_{y_i}\f$, or the variances \f$\sigma_{y_i}^2\f$ if m_errorIsVariance is set.
+  const unsigned char *m_mask; //!< Stores a flag per point, 0 for points that are ignored, or 0 if all points are used.
+  bool m_errorIsVariance; //!< Stores whether m_error holds variances.
+  bool m_isOwned; //!< Stores whether the columns point to the owned data.
+  int m_ndf; //!< Stores the number of points entering the \f$\chi^2\f$.
+
+  std::vector<std::vector<double> > m_xData; //!< Stores the owned \f$\vec{x_i}\f$ coordinates, one array per dimension.
+  std::vector<double> m_yData; //!< Stores the owned \f$y_i\f$ coordinates.
+  std::vector<double> m_errorData; //!< Stores the owned errors or variances.
+  std::vector<unsigned char> m_maskData; //!< Stores the owned flags of the points.
 };
 
 #endif
@@ -0,0 +1,45 @@
+#ifndef COMBINEDTERMINATION_H
+#define COMBINEDTERMINATION_H
+
+#include <vector>
+#include "ITerminationPolicy.h"
+
+/**
+ * @brief Combines several termination policies.
+ *
+ * In kAny mode, the optimization stops as soon as one of the policies tells it to stop (OR).
+ * In kAll mode, it stops once all policies tell it to stop at the same generation (AND).
+ * Combined policies can themselves be combined to build more complex conditions.
+ */
+class CombinedTermination : public ITerminationPolicy {
+
+public:
+
+  /** Combination modes. */
+  enum Mode {
+    kAny, //!< Stops if any policy says so.
+    kAll //!< Stops if all policies say so.
+  };
+
+  /** Constructor */
+  CombinedTermination(Mode mode=kAny);
+
+  /** Destructor */
+  ~CombinedTermination();
+
+  /** Adds a policy to the combination. */
+  void add(ITerminationPolicy *policy);
+
+  /** Resets all policies. */
+  void reset(IPopulation *population, int generation);
+
+  /** Decides whether the optimization should stop. */
+  bool shouldStop(IPopulation *population, int generation);
+
+private:
+
+  Mode m_mode; //!< Stores the combination mode.
+  std::vector<ITerminationPolicy*> m_policies; //!< Stores the combined policies.
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef COMPILEDCHI2FITNESS_H
+#define COMPILEDCHI2FITNESS_H
+
+#include "Chi2FitFigureOfMerit.h"
+
+#include <array>
+#include <stdexcept>
+#include <sstream>
+
+/**
+ * @brief \f$\chi^2/ndf\f$ of a compiled function, evaluated directly on its parameters.
+ *
+ * This is the fitness of StaticGeneticAlgorithm for the fit of a function known at compile time
+ * (see CompiledModel for the requirements on `Function`). The genome is the array of the parameters of
+ * the function, which is evaluated on the data without going through a model: the loop over the points
+ * inlines the function and can be vectorized, and the score is the same as the one of Chi2FitFigureOfMerit
+ * for a CompiledModel with the same parameters.
+ *
+ * The data is given through the interface of Chi2FitFigureOfMerit (see addData() and setData()), and the
+ * object remains a figure of merit for populations of models. The class is final, such that the calls made
+ * by StaticGeneticAlgorithm to isBetterThan() are resolved at compile time.
+ */
+template<class Function>
+class CompiledChi2Fitness final : public Chi2FitFigureOfMerit {
+
+public:
+
+  /** Genome holding the parameters of the function. */
+  typedef std::array<double, Function::kNpar> Genome;
+
+  /** Default Constructor */
+  CompiledChi2Fitness() : Chi2FitFigureOfMerit() {}
+
+  /** Sets the function object to be evaluated. */
+  void setFunction(const Function &function) { m_function = function; }
+
+  using Chi2FitFigureOfMerit::evaluate;
+
+  /** Compute the score (\f$\chi^2/ndf\f$) for the given parameters of the function. */
+  double evaluate(const Genome &genome) const;
+
+  /** Compares two score values: a lower \f$\chi^2/ndf\f$ is better. */
+  bool isBetterThan(double scoreToTest, double referenceScore) const { return scoreToTest < referenceScore; }
+
+  using Chi2FitFigureOfMerit::isBetterThan;
+
+  /** Decide if a genome can be accepted as a final answer, given its score. */
+  bool accept(const Genome &, double score) const { return isBetterThan(score, m_acceptThreshold); }
+
+  using Chi2FitFigureOfMerit::accept;
+
+private:
+
+  Function m_function; //!< Holds the function object.
+};
+
+/**
+ * The \f$\chi^2\f$ is accumulated over batches of points, like Chi2FitFigureOfMerit::evaluateBatch().
+ *
+ * @param genome Parameters of the function.
+ * @return \f$\chi^2/ndf\f$, or 0 if there is no data.
+ */
+template<class Function>
+double CompiledChi2Fitness<Function>::evaluate(const Genome &genome) const
+{
+  int npoints = m_npoints;
+  if(npoints == 0) return 0;
+  if((int)m_x.size() != Function::kNdim) {
+    std::ostringstream ostr;
+    ostr << "Number of dimensions (" << m_x.size() << ") differs from the compiled function (" << (int)Function::kNdim << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  double params[Function::kNpar];
+  for(int p=0; p<Function::kNpar; p++) params[p] = genome[p];
+
+  const Function function = m_function;
+  const double *y = m_y;
+  double weight[kBatchSize];
+  double point[Function::kNdim];
+  double chi2 = 0;
+
+  for(int begin=0; begin<npoints; begin+=kBatchSize) {
+    int nb = npoints-begin < kBatchSize ? npoints-begin : kBatchSize;
+    computeWeights(begin, nb, weight);
+    double sum = chi2;
+    if(Function::kNdim == 1) {
+      const double *x0 = m_x[0] + begin;
+      for(int i=0; i<nb; i++) {
+	double r = function(x0+i, params) - y[begin+i];
+	double w = weight[i];
+	sum += w != 0 ? r*r*w : 0;
+      }
+    }else{
+      for(int i=0; i<nb; i++) {
+	for(int d=0; d<Function::kNdim; d++) point[d] = m_x[d][begin+i];
+	double r = function(point, params) - y[begin+i];
+	double w = weight[i];
+	sum += w != 0 ? r*r*w : 0;
+      }
+    }
+    chi2 = sum;
+  }
+
+  return chi2 / m_ndf;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef COMPILEDMODEL_H
+#define COMPILEDMODEL_H
+
+#include "ParametricModel.h"
+
+#include <stdexcept>
+#include <sstream>
+
+/**
+ * @brief Class representing a parametric model whose function is compiled C++ code.
+ *
+ * The function is given as a type `Function` providing:
+ * - `static const int kNpar`: the number of parameters.
+ * - `static const int kNdim`: the number of dimensions.
+ * - `double operator()(const double *x, const double *p) const`: the value of the function at point `x`
+ * for the parameters `p`.
+ *
+ * Since the function is known at compile time, evaluating a batch of points compiles into a loop where
+ * the function is inlined, which the compiler can vectorize. The formula of the model is still used to
+ * define the parameter limits and to draw the model, and should describe the same function.
+ *
+ * Example of a gaussian function:
+ * \code{.cpp}
+ * struct Gaussian {
+ *   static const int kNpar = 3;
+ *   static const int kNdim = 1;
+ *   double operator()(const double *x, const double *p) const {
+ *     double t = (x[0]-p[1])/p[2];
+ *     return p[0]*exp(-0.5*t*t);
+ *   }
+ * };
+ * \endcode
+ */
+template<class Function>
+class CompiledModel : public ParametricModel {
+
+public:
+
+  /** Default Constructor */
+  CompiledModel() : ParametricModel() {}
+
+  /** Sets the function object used to evaluate this model. */
+  void setFunction(const Function &function) { m_function = function; }
+
+  /** Evaluates the function at a given point. */
+  double eval(const double *x) const;
+
+  /** Evaluates the function on a batch of points stored by columns. */
+  void evalBatch(int n, int ndim, const double *const *x, double *fx) const;
+
+protected:
+
+  Function m_function; //!< Holds the function object.
+};
+
+/**
+ * @param x Coordinates of the point.
+ * @return Value of the function at the given point.
+ */
+template<class Function>
+double CompiledModel<Function>::eval(const double *x) const
+{
+  return m_function(x, getParameters());
+}
+
+/**
+ * The parameters are copied locally such that the compiler knows they do not alias the output.
+ *
+ * @param n Number of points.
+ * @param ndim Number of dimensions of the points, which should match `Function::kNdim`.
+ * @param x Array of ndim arrays of n coordinates.
+ * @param fx Array of n values to be filled with the values of the function.
+ */
+template<class Function>
+void CompiledModel<Function>::evalBatch(int n, int ndim, const double *const *x, double *fx) const
+{
+  if(ndim != Function::kNdim) {
+    std::ostringstream ostr;
+    ostr << "Number of dimensions (" << ndim << ") differs from the compiled function (" << (int)Function::kNdim << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  double params[Function::kNpar];
+  const double *p = getParameters();
+  for(int i=0; i<Function::kNpar; i++) params[i] = p[i];
+
+  const Function function = m_function;
+  if(Function::kNdim == 1) {
+    const double *x0 = x[0];
+    for(int i=0; i<n; i++) {
+      fx[i] = function(x0+i, params);
+    }
+  }else{
+    double point[Function::kNdim];
+    for(int i=0; i<n; i++) {
+      for(int d=0; d<Function::kNdim; d++) point[d] = x[d][i];
+      fx[i] = function(point, params);
+    }
+  }
+}
+
+#endif
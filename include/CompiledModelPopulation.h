@@ -0,0 +1,76 @@
+#ifndef COMPILEDMODELPOPULATION_H
+#define COMPILEDMODELPOPULATION_H
+
+#include "ParametricModelPopulation.h"
+#include "CompiledModel.h"
+
+#include <stdexcept>
+#include <sstream>
+
+/**
+ * @brief Implements a population of parametric models whose function is compiled C++ code.
+ *
+ * This population behaves as a ParametricModelPopulation (same initialization, cross-over, mutation
+ * and storage modes), but the individuals are CompiledModel instances evaluating `Function`
+ * instead of the formula. See CompiledModel for the requirements on `Function`.
+ *
+ * The formula given through setFormula() defines the parameter limits and initial values, and must
+ * have `Function::kNpar` parameters. It is also what is returned by ParametricModel::getFormula(),
+ * e.g. to draw the models.
+ */
+template<class Function>
+class CompiledModelPopulation : public ParametricModelPopulation
+{
+
+public:
+
+  /** Default Constructor. */
+  CompiledModelPopulation() : ParametricModelPopulation() {}
+
+  /** Sets the function object given to the models. */
+  void setFunction(const Function &function) { m_function = function; }
+  
+protected:
+
+  /** Implements initialization. */
+  virtual void doInitialize(int n);
+
+  /** Creates a new compiled model. */
+  virtual ParametricModel *createModel();
+
+  Function m_function; //!< Stores the function object given to the models.
+};
+
+/**
+ * Checks that the formula matches the compiled function, then initializes as a ParametricModelPopulation.
+ * The function object is given again to all models, since they may have been recycled.
+ *
+ * @param n The desired size of the population.
+ */
+template<class Function>
+void CompiledModelPopulation<Function>::doInitialize(int n)
+{
+  if(m_formula->GetNpar() != Function::kNpar) {
+    std::ostringstream ostr;
+    ostr << "Number of parameters of the formula (" << m_formula->GetNpar()
+	 << ") differs from the compiled function (" << (int)Function::kNpar << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  ParametricModelPopulation::doInitialize(n);
+  for(int i=0; i<size(); i++) {
+    static_cast<CompiledModel<Function>*>(m_individuals[i])->setFunction(m_function);
+  }
+}
+
+/**
+ * @return A new CompiledModel, owned by the caller.
+ */
+template<class Function>
+ParametricModel *CompiledModelPopulation<Function>::createModel()
+{
+  CompiledModel<Function> *model = new CompiledModel<Function>();
+  model->setFunction(m_function);
+  return model;
+}
+
+#endif
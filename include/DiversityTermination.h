@@ -0,0 +1,46 @@
+#ifndef DIVERSITYTERMINATION_H
+#define DIVERSITYTERMINATION_H
+
+#include <vector>
+#include "ITerminationPolicy.h"
+
+/**
+ * @brief Stops when the genomes of the population have collapsed.
+ *
+ * The diversity of the population is the standard deviation of each gene across the individuals,
+ * relative to its value in the initial population, averaged over the genes. It starts around 1 and
+ * decreases as the population converges. Models that do not expose a genome (see IModel::getGenome())
+ * never trigger this policy.
+ */
+class DiversityTermination : public ITerminationPolicy {
+
+public:
+
+  /** Constructor */
+  DiversityTermination(double minDiversity);
+
+  /** Destructor */
+  ~DiversityTermination();
+
+  /** Records the initial diversity of each gene. */
+  void reset(IPopulation *population, int generation);
+
+  /** Decides whether the optimization should stop. */
+  bool shouldStop(IPopulation *population, int generation);
+
+  /** Returns the diversity at the last call to shouldStop(). */
+  double getDiversity();
+
+private:
+
+  /** Computes the standard deviation of each gene. */
+  int computeSpread(IPopulation *population, std::vector<double> &spread);
+
+  double m_minDiversity; //!< Stores the diversity below which the optimization stops.
+  double m_diversity; //!< Stores the diversity at the last call to shouldStop().
+  std::vector<double> m_initialSpread; //!< Stores the standard deviation of each gene in the initial population.
+  std::vector<double> m_spread; //!< Stores the standard deviation of each gene in the current population.
+  std::vector<double> m_sum; //!< Work buffer for the sums of the genes.
+};
+
+#endif
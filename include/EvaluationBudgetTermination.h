@@ -0,0 +1,34 @@
+#ifndef EVALUATIONBUDGETTERMINATION_H
+#define EVALUATIONBUDGETTERMINATION_H
+
+#include "ITerminationPolicy.h"
+
+/**
+ * @brief Stops when the figure of merit has been evaluated a given number of times.
+ *
+ * Only the evaluations made after the initialization are counted (see IPopulation::getCacheMisses()):
+ * scores inherited from the parents or found in the fitness cache are free.
+ */
+class EvaluationBudgetTermination : public ITerminationPolicy {
+
+public:
+
+  /** Constructor */
+  EvaluationBudgetTermination(long maxEvaluations);
+
+  /** Destructor */
+  ~EvaluationBudgetTermination();
+
+  /** Records the initial number of evaluations. */
+  void reset(IPopulation *population, int generation);
+
+  /** Decides whether the optimization should stop. */
+  bool shouldStop(IPopulation *population, int generation);
+
+private:
+
+  long m_maxEvaluations; //!< Stores the evaluation budget.
+  long m_start; //!< Stores the number of evaluations at the end of the initialization.
+};
+
+#endif
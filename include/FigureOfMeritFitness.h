@@ -0,0 +1,79 @@
+#ifndef FIGUREOFMERITFITNESS_H
+#define FIGUREOFMERITFITNESS_H
+
+#include "IFigureOfMerit.h"
+#include "ParametricModel.h"
+
+class TF1;
+
+/**
+ * @brief Adapts a figure of merit of parametric models to the fitness of StaticGeneticAlgorithm.
+ *
+ * Each genome is evaluated through a ParametricModel viewing its parameters with a given formula
+ * (see ParametricModel::setView()), such that any IFigureOfMerit can be used with the templated algorithm.
+ * Evaluations then go through the virtual interface of the figure of merit: this is the way to reuse
+ * existing figures of merit, while CompiledChi2Fitness evaluates compiled functions without it.
+ *
+ * The genome should provide `size()` and `data()`, e.g. `std::array<double, N>`, with the number of
+ * parameters of the formula. The formula and the figure of merit are not owned.
+ */
+template<class Genome>
+class FigureOfMeritFitness {
+
+public:
+
+  /** Default Constructor */
+  FigureOfMeritFitness() : m_fom(0), m_formula(0) {}
+
+  /** Constructor */
+  FigureOfMeritFitness(const IFigureOfMerit *fom, TF1 *formula) : m_fom(fom), m_formula(formula) {}
+
+  /** Compute the score of a genome. */
+  double evaluate(const Genome &genome) const;
+
+  /** Compares two scores. */
+  bool isBetterThan(double scoreToTest, double referenceScore) const { return m_fom->isBetterThan(scoreToTest, referenceScore); }
+
+  /** Decide if a genome can be accepted as a final answer. */
+  bool accept(const Genome &genome, double score) const;
+
+  /** Returns whether evaluate() can be called concurrently from several threads. */
+  bool isThreadSafe() const { return m_fom->isThreadSafe(); }
+
+private:
+
+  const IFigureOfMerit *m_fom; //!< Stores the figure of merit.
+  TF1 *m_formula; //!< Stores the formula of the models.
+};
+
+/**
+ * The parameters are copied, since a view may modify them.
+ *
+ * @param genome Parameters of the model.
+ * @return Score of the model.
+ */
+template<class Genome>
+double FigureOfMeritFitness<Genome>::evaluate(const Genome &genome) const
+{
+  Genome parameters = genome;
+  ParametricModel model;
+  model.setView(m_formula, parameters.data());
+  return m_fom->evaluate(&model);
+}
+
+/**
+ * @param genome Parameters of the model.
+ * @param score Score of the model.
+ * @return true if the model can be accepted.
+ */
+template<class Genome>
+bool FigureOfMeritFitness<Genome>::accept(const Genome &genome, double score) const
+{
+  Genome parameters = genome;
+  ParametricModel model;
+  model.setView(m_formula, parameters.data());
+  model.setScore(score);
+  return m_fom->accept(&model);
+}
+
+#endif
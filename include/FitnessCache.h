@@ -0,0 +1,79 @@
+#ifndef FITNESSCACHE_H
+#define FITNESSCACHE_H
+
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @brief Least-recently-used cache of scores keyed on genomes.
+ *
+ * The cache maps genomes (arrays of a fixed number of real numbers) to their score. 
+ * Genomes are hashed, and the full genome is stored and compared such that hash collisions
+ * never return a wrong score. When the cache is full, the least recently used entry is replaced.
+ *
+ * All the memory is allocated when the capacity or the genome size changes: lookups and insertions
+ * do not allocate memory.
+ */
+class FitnessCache {
+
+public:
+
+  /** Default Constructor */
+  FitnessCache();
+
+  /** Destructor */
+  ~FitnessCache();
+
+  /** Sets the maximum number of entries in the cache. */
+  void setCapacity(int capacity);
+
+  /** Returns the maximum number of entries in the cache. */
+  int getCapacity() const;
+
+  /** Returns the number of entries in the cache. */
+  int size() const;
+
+  /** Removes all entries. */
+  void clear();
+
+  /** Looks up the score of a genome. */
+  bool find(const double *genome, int genomeSize, double &score);
+
+  /** Stores the score of a genome. */
+  void insert(const double *genome, int genomeSize, double score);
+
+private:
+
+  /** Computes the hash of a genome. */
+  uint64_t hash(const double *genome) const;
+
+  /** Returns the position of a genome in the hash table, or of the empty slot where it would be inserted. */
+  int lookup(const double *genome, uint64_t h) const;
+
+  /** Allocates the storage for the current capacity and genome size. */
+  void allocate();
+
+  /** Moves an entry to the most recently used position. */
+  void touch(int entry);
+
+  /** Removes an entry from the recency list. */
+  void unlink(int entry);
+
+  /** Removes an entry from the hash table. */
+  void erase(int entry);
+
+  int m_capacity; //!< Stores the maximum number of entries.
+  int m_genomeSize; //!< Stores the number of values per genome.
+  int m_size; //!< Stores the number of entries.
+  int m_head; //!< Stores the most recently used entry, or -1.
+  int m_tail; //!< Stores the least recently used entry, or -1.
+  std::vector<double> m_genomes; //!< Stores the genomes of the entries.
+  std::vector<double> m_scores; //!< Stores the scores of the entries.
+  std::vector<uint64_t> m_hashes; //!< Stores the hashes of the entries.
+  std::vector<int> m_prev; //!< Stores the previous (more recently used) entry, or -1.
+  std::vector<int> m_next; //!< Stores the next (less recently used) entry, or -1.
+  std::vector<int> m_slot; //!< Stores the position of each entry in the hash table.
+  std::vector<int> m_table; //!< Open-addressing hash table of entries, -1 for empty slots.
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef GENERATIONSTATS_H
+#define GENERATIONSTATS_H
+
+/**
+ * @brief Time spent in each stage of a generation, and counters.
+ *
+ * Times are wall-clock times in seconds. The stages are timed on the calling thread: a stage running on
+ * several threads counts once. The random draws and heap allocations are only counted if the
+ * instrumentation counters are compiled in (see InstrumentationCounters), and are -1 otherwise.
+ */
+struct GenerationStats {
+
+  /** Default Constructor. */
+  GenerationStats();
+
+  /** Resets all times and counters. */
+  void clear();
+
+  int generation; //!< Number of the generation.
+  double totalTime; //!< Time spent on the whole generation.
+  double scoreTime; //!< Time spent computing the scores.
+  double sortTime; //!< Time spent ranking the individuals.
+  double selectionTime; //!< Time spent selecting the parents.
+  double crossOverTime; //!< Time spent crossing-over the parents.
+  double mutationTime; //!< Time spent mutating the offspring.
+  long nEvaluations; //!< Number of scores computed by the figure of merit.
+  long cacheHits; //!< Number of scores that did not need to be computed.
+  long randomDraws; //!< Number of random numbers drawn, or -1.
+  long allocations; //!< Number of heap allocations, or -1.
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef GENERATIONTRACE_H
+#define GENERATIONTRACE_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * @brief Columns describing the progress of an optimization, one row per generation.
+ *
+ * Each row holds the generation number, the score of the best fitted individual, the mean and RMS of the
+ * scores, and the parameters (genome) of the best fitted individual.
+ *
+ * Traces are written by TraceWriter into an append-only file made of a header followed by blocks of rows:
+ * - The header holds the magic string "GATRACE", the format version and the number of parameters.
+ * - Each block holds its number of rows, followed by one array per column: generations (32-bit integers),
+ * best scores, score means, score RMS, then one array per parameter (doubles).
+ *
+ * The values are stored in the native byte order. A file can be read (see read()) while it is written,
+ * or after an interrupted run: an incomplete last block is ignored.
+ */
+class GenerationTrace {
+
+public:
+
+  /** Default Constructor */
+  GenerationTrace();
+
+  /** Sets the number of parameters per row, and removes all rows. */
+  void setNPar(int npar);
+
+  /** Returns the number of parameters per row. */
+  int getNPar() const;
+
+  /** Returns the number of rows. */
+  int size() const;
+
+  /** Appends a row. */
+  void append(int generation, double best, double mean, double rms, const double *parameters);
+
+  /** Removes all rows, keeping the memory allocated. */
+  void clear();
+
+  /** Reads all the rows of a trace file. */
+  void read(const std::string &path);
+
+  /** Writes the header of a trace file. */
+  void writeHeader(std::ostream &out) const;
+
+  /** Writes the rows as a block of a trace file. */
+  void writeBlock(std::ostream &out) const;
+
+  /** Version of the file format. */
+  static const uint32_t kVersion = 1;
+
+  std::vector<int32_t> generations; //!< Generation numbers.
+  std::vector<double> bestScores; //!< Scores of the best fitted individuals.
+  std::vector<double> scoreMeans; //!< Means of the scores.
+  std::vector<double> scoreRMS; //!< RMS of the scores.
+  std::vector<std::vector<double> > bestParameters; //!< Parameters of the best fitted individuals, one column per parameter.
+};
+
+#endif
@@ -1,9 +1,16 @@
 #ifndef GENETICALGORITHM_H
 #define GENETICALGORITHM_H
 
+#include "GenerationStats.h"
+#include "Checkpoint.h"
+
 class IModel;
 class IFigureOfMerit;
 class IPopulation;
+class StatsLogger;
+class ITerminationPolicy;
+class CheckpointWriter;
+class TraceWriter;
 
 /**
  * @brief Class imlementing the Genetic Algorithm.
@@ -19,6 +26,22 @@ class IPopulation;
  *   - Cross them over to form a new population.
  *   - Mutate some individuals.
  *   - Rank the new population.
+ *
+ * In steady-state mode (see setSteadyState()), each iteration only replaces a few of the least fitted
+ * individuals with new offspring, and only these offspring are evaluated (see IPopulation::breedSteadyState()).
+ *
+ * Besides the acceptance by the figure of merit and the maximum number of generations, the optimization can be
+ * stopped early by a termination policy (see setTerminationPolicy()).
+ *
+ * When instrumentation is enabled (see setInstrumentation()), the time spent in each stage of a generation and the
+ * number of evaluations are recorded (see getGenerationStats()), and can be streamed to a file (see setStatsLogger()).
+ * The progress of the optimization (best score, mean and RMS of the scores, best parameters) can be streamed to a
+ * trace file for offline rendering (see setTraceWriter()).
+ *
+ * The state of the optimization can be saved periodically to a file (see setCheckpointWriter()), and the
+ * optimization resumed from it (see initialize(IPopulation*, const Checkpoint&)) with the same results as if it had
+ * not been interrupted. Termination policies are reset when resuming, from the generation of the checkpoint,
+ * such that they only observe the generations following it.
  */
 class GeneticAlgorithm {
 
@@ -36,6 +59,12 @@ public:
   /** Initialize the algorithm before the optimization loop starts. */
   void initialize(IPopulation *population);
 
+  /** Finds the best solution, resuming from a checkpoint. */
+  IModel *optimize(IPopulation *population, const Checkpoint &checkpoint);
+
+  /** Initialize the algorithm from a checkpoint instead of a new population. */
+  void initialize(IPopulation *population, const Checkpoint &checkpoint);
+
   /** Perform one iteration of the optimization loop: creates next generation of models. */
   bool nextGeneration();
 
@@ -48,12 +77,48 @@ public:
   /** Sets the population size */
   void setPopulationSize(int populationSize);
 
+  /** Sets the number of offspring per iteration in steady-state mode. */
+  void setSteadyState(int nOffspring);
+
+  /** Sets the policy deciding whether to stop the optimization early. */
+  void setTerminationPolicy(ITerminationPolicy *policy);
+
+  /** Enables or disables the recording of the statistics of each generation. */
+  void setInstrumentation(bool enable);
+
+  /** Returns the statistics of the last generation. */
+  const GenerationStats &getGenerationStats();
+
+  /** Sets the logger receiving the statistics of each generation. */
+  void setStatsLogger(StatsLogger *logger);
+
+  /** Sets the writer receiving the progress of each generation. */
+  void setTraceWriter(TraceWriter *writer);
+
+  /** Sets the writer receiving a checkpoint every given number of generations. */
+  void setCheckpointWriter(CheckpointWriter *writer, int interval);
+
+  /** Saves the current state of the optimization into a checkpoint. */
+  void saveCheckpoint(Checkpoint &checkpoint);
+
 private:
 
+  /** Records the progress of the current generation in the trace. */
+  void recordTrace();
+
   int m_generationsMax; //!< Stores the maximum number of generations.
   int m_populationSize; //!< Stores the desired population size.
   int m_currentGeneration; //!< Stores the number of the current generation.
+  int m_nOffspring; //!< Stores the number of offspring per iteration in steady-state mode (0 to replace whole generations).
   IPopulation *m_population; //!< Stores a pointer to the population being optimized.
+  ITerminationPolicy *m_terminationPolicy; //!< Stores the policy deciding whether to stop the optimization early, if any.
+  bool m_instrumented; //!< Stores whether the statistics of each generation are recorded.
+  GenerationStats m_stats; //!< Stores the statistics of the last generation.
+  StatsLogger *m_statsLogger; //!< Stores the logger receiving the statistics of each generation, if any.
+  TraceWriter *m_traceWriter; //!< Stores the writer receiving the progress of each generation, if any.
+  CheckpointWriter *m_checkpointWriter; //!< Stores the writer receiving the checkpoints, if any.
+  int m_checkpointInterval; //!< Stores the number of generations between checkpoints.
+  Checkpoint m_checkpoint; //!< Stores the last checkpoint taken, reused from one checkpoint to the next.
 };
 
 #endif
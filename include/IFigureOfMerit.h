@@ -15,11 +15,16 @@ class IModel;
  *
  * Deriving from this class:
  * - Derived classes should at least implement the `evaluate()` method if the score handling behavior is adequate.
+ * Populations compute the scores through `evaluateBatch()`, which calls `evaluate()` for each model by default.
+ * Derived classes can reimplement it to amortize the setup of the evaluation over many models.
  * - In addition, derived classes may reimplement `accept()` and/or `isBetterThan()` versions that take scores as input
  * to modify the handling of the scores, e.g. a lower score is may be better.
  * - For more complex cases where the decisions are not taken solely on the score, the derived class may
  * reimplement the overloaded versions of `accept()` and `isBetterThan()` that take a IModel as input. 
- * In this case, the fuction `evaluate()` may simply return a dummy value.
+ * In this case, the fuction `evaluate()` may simply return a dummy value, and `ranksOnScore()` should
+ * return false so that populations do not rank models using their cached scores.
+ * - Derived classes whose `evaluate()` can safely run concurrently on different models should reimplement
+ * `isThreadSafe()` to return true, which allows populations to compute scores on several threads.
  * 
  */
 class IFigureOfMerit {
@@ -39,12 +44,24 @@ public:
    */
   virtual double evaluate(IModel *model) const =0;
 
+  /** Evaluate the fittness of several models at once. */
+  virtual void evaluateBatch(IModel *const *models, int n, double *scores) const;
+
+  /** Returns whether evaluate() can be called concurrently from several threads. */
+  virtual bool isThreadSafe() const;
+
   /** Decide if a model can be accepted as a final answer. */
   virtual bool accept(IModel *model) const;
 
   /** Compares two Models */
   virtual bool isBetterThan(IModel *scoreToTest, IModel *referenceModel) const;
 
+  /** Compares two scores */
+  virtual bool isBetterThan(double scoreToTest, double referenceScore) const;
+
+  /** Returns whether models can be ranked using their scores only. */
+  virtual bool ranksOnScore() const;
+
   /** Sets the score threshold to accept a model as a final answer. */
   void setAcceptThreshold(double acceptThreshold);
 
@@ -55,9 +72,6 @@ protected:
   
   /** Decide if a model's score can be accepted as a final answer. */
   virtual bool accept(double scrore) const;
-  
-  /** Compares two scores */
-  virtual bool isBetterThan(double scoreToTest, double referenceScore) const;
 
   double m_acceptThreshold; //!< Stores the score threshold to accept a model as a final answer.
 };
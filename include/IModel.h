@@ -9,6 +9,11 @@
  *
  * The only functionality provided in this interface is set/get accessors for the score.
  * The score calculation is expected to be delegated to a class inheriting from IFigureOfMerit.
+ *
+ * A model is dirty when its score is not up to date, e.g. after a mutation. Setting the score makes it clean.
+ *
+ * Models that can be described by an array of real numbers (the genome) may expose it through getGenome().
+ * Two models with the same genome are expected to have the same score: this allows populations to reuse scores.
  */
 class IModel {
 
@@ -25,10 +30,26 @@ public:
 
   /** Sets the score for this model. */
   void setScore(double score);
+
+  /** Returns whether the score needs to be recomputed. */
+  bool isDirty() const;
+
+  /** Marks the score as needing to be recomputed. */
+  void setDirty();
+
+  /** Returns the number of values in the genome of this model. */
+  virtual int getGenomeSize() const;
+
+  /** Returns the genome of this model. */
+  virtual const double *getGenome() const;
+
+  /** Sets the genome of this model. */
+  virtual void setGenome(const double *genome);
   
 protected:
 
   double m_score; //!< Holds the score for this model.
+  bool m_dirty; //!< Holds whether the score needs to be recomputed.
 };
 
 #endif
@@ -0,0 +1,44 @@
+#ifndef IPARENTSELECTOR_H
+#define IPARENTSELECTOR_H
+
+#include <vector>
+#include "RandomStream.h"
+
+/**
+ * @brief Abstract class describing a strategy to select the parents to be crossed-over.
+ *
+ * At each generation, the population calls prepare() with the scores of the individuals eligible as parents,
+ * ranked from the best to the least fitted, then select() to draw the parents of all offspring at once.
+ * Parents are identified by their rank.
+ *
+ * Derive from this class by implementing select(). Strategies that need to precompute tables
+ * from the scores should do it by overriding prepare(), such that each draw is cheap.
+ */
+class IParentSelector {
+
+public:
+
+  /** Default Constructor */
+  IParentSelector();
+
+  /** Destructor */
+  virtual ~IParentSelector();
+
+  /** Prepares the selection among the ranked individuals of a generation. */
+  virtual void prepare(int n, const double *scores);
+
+  /** Selects the pairs of parents of several offspring. */
+  virtual void select(int nPairs, int *parents, RandomStream &random)=0;
+
+protected:
+
+  /** Computes selection weights proportional to the fitness of the individuals. */
+  static double computeFitness(int n, const double *scores, std::vector<double> &weights);
+
+  /** Draws an individual uniformly, excluding a given one. */
+  static int drawOther(int exclude, int n, RandomStream &random);
+
+  int m_n; //!< Stores the number of individuals eligible as parents.
+};
+
+#endif
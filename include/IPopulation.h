@@ -2,10 +2,17 @@
 #define IPOPULATION_H
 
 #include <vector>
-#include "TRandom3.h"
+#include <typeinfo>
+#include "RandomStream.h"
+#include "FitnessCache.h"
+#include "GenerationStats.h"
 
 class IModel;
 class IFigureOfMerit;
+class ThreadPool;
+class IParentSelector;
+class Checkpoint;
+class ModelPool;
 
 /**
  * @brief Abstract class describing a population of models.
@@ -14,15 +21,50 @@ class IFigureOfMerit;
  * - Initialize the population: usually this use a random number generator. 
  * The actual implementation is left to the derived classes.
  * - Selection: decide which members of the population should be cross-overed.
- * The default behavior is to select parents with a probability that is linear with the rank.
+ * The default behavior is to select parents with a probability that is linear with the rank
+ * (see LinearRankSelector). Other strategies can be set using setParentSelector().
  * - Cross-over: implements the logic based on which a child is constructed from its parents.
  * - Mutation: implements the logic based on which a child is altered through random mutations.
  *
- * Derive from this class by implementing at least these three methods:
+ * Derive from this class by implementing at least these four methods:
  * - doInitialize(): performs the initialization of the population
- * - doCrossOver(): performs the cross-over. 
+ * - doCrossOver(): produces a range of offspring, given a flat list of parent indices. 
+ * - doReplaceParents(): replaces a range of the current generation with the offspring.
  * - doMutate(): performs the mutation of a model.
  * Additionally, one might override the selectParents() method to change its default behavior.
+ * In most cases, providing an IParentSelector through setParentSelector() is sufficient.
+ *
+ * Ranking is performed on the cached scores in \f$O(n\log n)\f$. When a selection window is set
+ * (see setSelectionWindow()), only the individuals inside the window are fully ranked: the rest of
+ * the population is partitioned away in linear time and only ranked if explicitly requested through
+ * getBestFitted().
+ *
+ * Scoring can be distributed over several threads (see setNThreads()), provided the figure of merit
+ * declares its evaluation as thread-safe. Likewise, cross-over and mutation are distributed over chunks
+ * of the population if the derived class declares them as thread-safe (see isBreedingThreadSafe()).
+ * Scores are then reduced in a fixed order, such that the results do not depend on the number of threads.
+ *
+ * Random numbers are drawn from counter-based streams (see RandomStream) specific to each generation,
+ * individual and operation, such that the results only depend on the random seed (see setRandomSeed()),
+ * and not on the order in which individuals are processed.
+ *
+ * Only individuals whose score is out of date (see IModel::isDirty()) are evaluated: the best fitted
+ * individual preserved by the cross-over, and offspring identical to one of their parents, inherit the
+ * score of their parent. In addition, a cache of the scores keyed on the genomes of the individuals can
+ * be enabled across generations (see setFitnessCacheSize()).
+ *
+ * Instead of replacing whole generations, the population can also evolve in steady state
+ * (see breedSteadyState()), where each step only replaces a few of the least fitted individuals.
+ *
+ * When instrumented (see setInstrumentation()), the population measures the time spent in each stage
+ * and counts the evaluations (see getStats()).
+ *
+ * Models are recycled through a pool (see ModelPool): clearing the population gives its models back to
+ * the pool, and derived classes take models from it with acquireModel() before creating new ones.
+ * Re-initializing a population therefore resets existing models instead of allocating new ones.
+ *
+ * The state of the population can be saved into a Checkpoint (see saveState()), and restored later
+ * into a population of the same size (see restoreState()) to continue the evolution with the same results.
  */
 class IPopulation {
 
@@ -46,12 +88,81 @@ public:
   /** Compute the scores for the members of the population. */
   void score();
 
+  /** Replaces the least fitted individuals with new offspring (steady-state evolution). */
+  void breedSteadyState(int nOffspring);
+
+  /** Scores and ranks the whole population before steady-state evolution. */
+  void prepareSteadyState();
+
+  /** Replaces the last ranked individuals with new offspring, outside of the ranking. */
+  void breedOffspring(int begin, int end);
+
+  /** Inserts scored offspring into the ranking. */
+  void insertOffspring(int begin, int end);
+
+  /** Finds the individuals of a range whose score needs to be evaluated. */
+  int findUnscored(int begin, int end, std::vector<IModel*> &unscored);
+
+  /** Sets the scores of evaluated individuals. */
+  void setScores(IModel *const *models, int n, const double *scores);
+
   /** Sets the random seed for the random number generator. */
   void setRandomSeed(int seed);
 
   /** Sets the mutation rate. */
   void setMutateRate(double rate);
 
+  /** Sets the number of threads used to breed and score the population. */
+  void setNThreads(int nThreads);
+
+  /** Sets the number of individuals per chunk of work distributed to the threads. */
+  void setChunkSize(int chunkSize);
+
+  /** Sets the number of genomes whose score is remembered across generations. */
+  void setFitnessCacheSize(int capacity);
+
+  /** Marks the scores of all individuals as out of date, and clears the fitness cache. */
+  void invalidateScores();
+
+  /** Returns the number of scores that did not need to be evaluated. */
+  long getCacheHits();
+
+  /** Returns the number of scores that were evaluated. */
+  long getCacheMisses();
+
+  /** Resets the cache hits and misses counters. */
+  void resetCacheCounters();
+
+  /** Enables or disables the timing of the stages. */
+  void setInstrumentation(bool enable);
+
+  /** Returns whether the stages are timed. */
+  bool isInstrumented();
+
+  /** Returns the times and counters accumulated since the last call to resetStats(). */
+  const GenerationStats &getStats();
+
+  /** Resets the times and counters. */
+  void resetStats();
+
+  /** Replaces the least fitted individuals with the given genomes. */
+  void replaceWorst(int n, int genomeSize, const double *genomes, const double *scores);
+
+  /** Saves the state of the population into a checkpoint. */
+  void saveState(Checkpoint &checkpoint);
+
+  /** Restores the state of the population from a checkpoint. */
+  void restoreState(const Checkpoint &checkpoint);
+
+  /** Restricts parent selection to the best fitted individuals. */
+  void setSelectionWindow(int window);
+
+  /** Sets the strategy used to select the parents to be crossed-over. */
+  void setParentSelector(IParentSelector *selector);
+
+  /** Returns the strategy used to select the parents to be crossed-over. */
+  IParentSelector *getParentSelector();
+
   /** Sets the figure of merit to be used to calculate scores and perform the ranking. */
   void setFigureOfMerit(IFigureOfMerit *fom);
 
@@ -61,6 +172,9 @@ public:
   /** Returns the method at a given rank. */
   IModel *getBestFitted(int rank=0);
 
+  /** Returns the model at a given position, without ranking the population. */
+  IModel *getIndividual(int index);
+
   /** Returns the size of the population. */
   int size();
 
@@ -70,37 +184,111 @@ public:
   /** Returns the RMS of the scores for the population. */
   double getScoreRMS();
 
-  /** Resets the population. */
+  /** Resets the population, giving its models back to the pool. */
   void clear();
+
+  /** Sets the pool recycling the models of this population. */
+  void setModelPool(ModelPool *pool);
+
+  /** Returns the pool recycling the models of this population. */
+  ModelPool *getModelPool();
   
 protected:
 
   /** Should implement the actual initialization. */
   virtual void doInitialize(int n)=0;
 
-  /** Should implement the cross-over. */
-  virtual void doCrossOver(const std::vector<std::vector<IModel*> > &parents)=0;
+  /** Should produce the offspring in a range of the next generation. */
+  virtual void doCrossOver(const std::vector<int> &parents, int begin, int end)=0;
+
+  /** Should replace a range of the current generation with the offspring. */
+  virtual void doReplaceParents(int begin, int end)=0;
 
   /** Should implement the mutation of a model. */
-  virtual void doMutate(IModel *model)=0;
+  virtual void doMutate(IModel *model, RandomStream &random)=0;
+
+  /** Returns whether doCrossOver() and doMutate() can be called concurrently on disjoint ranges. */
+  virtual bool isBreedingThreadSafe() const;
 
-  /** Selects parents to be crossed-over */
-  virtual void selectParents(int &p1, int &p2);
+  /** Selects the parents of several offspring. */
+  virtual void selectParents(int nPairs, int *parents);
 
   /** Performs the ranking from the best to the least fitted. */
-  void sort();
+  void sort(int nBest=0);
+
+  /** Returns the number of individuals among which parents are selected. */
+  int selectionSize();
 
   /** Makes sure an IFigureOfMerit object is assigned to this population. */
   void checkFigureOfMerit();
 
+  /** Takes a model created by this type of population out of the pool. */
+  IModel *acquireModel();
+
+  /** Returns the random stream of an individual for a given operation in the current generation. */
+  RandomStream getRandomStream(int individual, int operation);
+
   double m_mutateRate; //!< Stores the mutate rate.
-  bool m_sorted; //!< Stores whether the ranking is valid or needs to be redone.
+  int m_nRanked; //!< Stores the number of leading individuals whose ranking is valid.
+  int m_selectionWindow; //!< Stores the number of best fitted individuals eligible as parents (0 for all).
   std::vector<IModel*> m_individuals; //!< Stores the individuals of this population.
   IFigureOfMerit *m_fom; //!< Stores the figure of merit to be used to calculate scores and perform the ranking.
-  TRandom3 *m_random; //!< Stores a random number generator.
+  unsigned long long m_seed; //!< Stores the random seed.
+  unsigned long long m_generation; //!< Stores the number of generations bred since the initialization, used to derive the random streams.
   double m_scoreMean; //!< Stores the mean score for the population.
   double m_scoreRMS; //!< Stores the score RMS for the population.
-  std::vector<std::vector<IModel*> > m_parents; //!< Stores the list of parents about to be crossed-over.
+  double m_scoreSum; //!< Stores the sum of the scores for the population.
+  double m_scoreSum2; //!< Stores the sum of the squared scores for the population.
+  std::vector<int> m_parents; //!< Stores the indices of the two parents of each offspring about to be crossed-over.
+  std::vector<int> m_copies; //!< Stores, for each offspring, the index of the parent it is identical to, or -1.
+  std::vector<double> m_scores; //!< Stores the scores computed by the figure of merit.
+  std::vector<IModel*> m_toScore; //!< Stores the individuals whose score needs to be evaluated.
+  std::vector<double> m_parentScores; //!< Stores the scores of the parents during cross-over.
+  std::vector<char> m_parentDirty; //!< Stores whether the scores of the parents are out of date during cross-over.
+  FitnessCache m_cache; //!< Stores the scores of recently evaluated genomes.
+  long m_cacheHits; //!< Stores the number of scores that did not need to be evaluated.
+  long m_cacheMisses; //!< Stores the number of scores that were evaluated.
+  ThreadPool *m_threadPool; //!< Stores the pool of threads used to breed and score the population, if any.
+  int m_chunkSize; //!< Stores the number of individuals per chunk of work (0 for automatic).
+  IParentSelector *m_parentSelector; //!< Stores the strategy used to select the parents.
+  IParentSelector *m_defaultParentSelector; //!< Stores the default strategy used to select the parents.
+  bool m_instrumented; //!< Stores whether the stages are timed.
+  GenerationStats m_stats; //!< Stores the times and counters accumulated since the last call to resetStats().
+  ModelPool *m_modelPool; //!< Stores the pool recycling the models.
+  ModelPool *m_defaultModelPool; //!< Stores the pool owned by this population.
+  const std::type_info *m_modelOwner; //!< Stores the type of population that created the models, or 0 if they do not come from acquireModel().
+
+private:
+
+  /** Sort key caching the score and the current position of an individual. */
+  struct RankKey {
+    double score; //!< Cached score of the individual.
+    int index; //!< Position of the individual before ranking.
+    IModel *model; //!< The individual itself.
+  };
+
+  /** Ranks the best fitted individuals using the given ordering. */
+  template<class Compare> void rank(int nBest, Compare compare);
+
+  /** Merges new individuals following the ranked ones into the ranking. */
+  template<class Compare> void insertRanked(int begin, int n, Compare compare);
+
+  /** Mutates a range of individuals. */
+  void mutateRange(int begin, int end);
+
+  /** Computes the out of date scores in a range of individuals. */
+  int scoreRange(int begin, int end);
+
+  /** Computes the mean and RMS of the scores from their sums. */
+  void updateScoreMoments(int n);
+
+  bool m_rankedScoresValid; //!< Stores whether the ranked individuals have their scores in m_parentScores, as needed by steady-state evolution.
+  std::vector<RankKey> m_rankKeys; //!< Work buffer for the ranking, kept to avoid reallocations.
+  std::vector<IModel*> m_rankBuffer; //!< Work buffer for the ranking, kept to avoid reallocations.
+  long m_statsCacheHits; //!< Stores the cache hits at the last call to resetStats().
+  long m_statsCacheMisses; //!< Stores the cache misses at the last call to resetStats().
+  long m_statsRandomDraws; //!< Stores the random draws at the last call to resetStats().
+  long m_statsAllocations; //!< Stores the heap allocations at the last call to resetStats().
 };
 
 #endif
@@ -0,0 +1,34 @@
+#ifndef ITERMINATIONPOLICY_H
+#define ITERMINATIONPOLICY_H
+
+class IPopulation;
+
+/**
+ * @brief Abstract class describing a criterion to stop the optimization early.
+ *
+ * The algorithm calls reset() once the population is initialized and scored, or restored from a checkpoint,
+ * with the generation it starts from, then shouldStop() before each generation. The optimization then stops
+ * if the best fitted model is accepted by the figure of merit, if the maximum number of generations is reached,
+ * or if the policy tells it to stop.
+ *
+ * Derive from this class by implementing shouldStop(). Policies that need a reference state, such as
+ * a starting time, should record it by overriding reset(). Policies can be combined with CombinedTermination.
+ */
+class ITerminationPolicy {
+
+public:
+
+  /** Default Constructor */
+  ITerminationPolicy();
+
+  /** Destructor */
+  virtual ~ITerminationPolicy();
+
+  /** Records the initial state of the optimization. */
+  virtual void reset(IPopulation *population, int generation);
+
+  /** Decides whether the optimization should stop. */
+  virtual bool shouldStop(IPopulation *population, int generation)=0;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef INSTRUMENTATIONCOUNTERS_H
+#define INSTRUMENTATIONCOUNTERS_H
+
+#ifdef GA_INSTRUMENTATION_COUNTERS
+#include <atomic>
+#endif
+
+/**
+ * @brief Process-wide counters of random draws and heap allocations.
+ *
+ * The counters are compiled in only if GA_INSTRUMENTATION_COUNTERS is defined (see the makefile, or the CMake option of the same name), for the library
+ * and for the code using it. They then add an atomic increment to each random number drawn from a RandomStream,
+ * and replace the global allocation functions to count heap allocations. Otherwise, counting costs nothing
+ * and the counters return -1.
+ *
+ * The counts are shared by all the threads and populations of the process.
+ */
+class InstrumentationCounters {
+
+public:
+
+  /** Returns whether the counters are compiled in. */
+  static bool isEnabled();
+
+  /** Counts one random draw. */
+  static void countRandomDraw()
+  {
+#ifdef GA_INSTRUMENTATION_COUNTERS
+    m_randomDraws.fetch_add(1, std::memory_order_relaxed);
+#endif
+  }
+
+  /** Counts one heap allocation. */
+  static void countAllocation()
+  {
+#ifdef GA_INSTRUMENTATION_COUNTERS
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+  }
+
+  /** Returns the number of random draws since the start of the process. */
+  static long getRandomDraws();
+
+  /** Returns the number of heap allocations since the start of the process. */
+  static long getAllocations();
+
+#ifdef GA_INSTRUMENTATION_COUNTERS
+private:
+
+  static std::atomic<long> m_randomDraws; //!< Stores the number of random draws.
+  static std::atomic<long> m_allocations; //!< Stores the number of heap allocations.
+#endif
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef ISLANDGENETICALGORITHM_H
+#define ISLANDGENETICALGORITHM_H
+
+#include <vector>
+
+class IModel;
+class IPopulation;
+class GeneticAlgorithm;
+class ThreadPool;
+
+/**
+ * @brief Class implementing the island model of the Genetic Algorithm.
+ *
+ * Several populations (the islands) are evolved independently, each on its own thread and with its own
+ * random number generator seed. Every few generations, the best fitted individuals of each island migrate
+ * to other islands, where they replace the least fitted individuals.
+ *
+ * Two migration topologies are available:
+ * - kRing: island \f$i\f$ sends its migrants to island \f$i+1\f$, the last island sending to the first one.
+ * - kFullyConnected: each island sends its migrants to all other islands.
+ *
+ * All islands should solve the same problem with the same type of models, and the individuals should expose
+ * their genome (see IModel::getGenome()). Islands may share a figure of merit only if it is thread-safe
+ * (see IFigureOfMerit::isThreadSafe()).
+ *
+ * The optimization stops as soon as one island finds an acceptable solution, or when the maximum
+ * number of generations is reached.
+ */
+class IslandGeneticAlgorithm {
+
+public:
+
+  /** Migration topologies. */
+  enum Topology {
+    kRing, //!< Each island sends migrants to the next one.
+    kFullyConnected //!< Each island sends migrants to all other islands.
+  };
+
+  /** Default Constructor */
+  IslandGeneticAlgorithm();
+
+  /** Destructor */
+  ~IslandGeneticAlgorithm();
+
+  /** Adds a population to be evolved as an island. */
+  void addIsland(IPopulation *population);
+
+  /** Returns the number of islands. */
+  int getNIslands();
+
+  /** Returns the population of an island. */
+  IPopulation *getIsland(int i);
+
+  /** Finds the best solution across all islands. */
+  IModel *optimize();
+
+  /** Initialize the islands before the optimization loop starts. */
+  void initialize();
+
+  /** Evolves all islands until the next migration, then performs the migration. */
+  bool nextEpoch();
+
+  /** Returns the best fitted individual across all islands. */
+  IModel *getBestFitted();
+
+  /** Returns the current generation number. */
+  int getCurrentGeneration();
+
+  /** Sets the maximum number of generations before giving up. */
+  void setNGenerationsMax(int generationsMax);
+
+  /** Sets the population size of each island. */
+  void setPopulationSize(int populationSize);
+
+  /** Sets the seed from which the random number generator seed of each island is derived. */
+  void setRandomSeed(int seed);
+
+  /** Sets the migration topology. */
+  void setTopology(Topology topology);
+
+  /** Sets the number of generations between two migrations. */
+  void setMigrationInterval(int generations);
+
+  /** Sets the number of individuals sent by an island to each destination. */
+  void setNMigrants(int nMigrants);
+
+private:
+
+  /** Sends migrants between islands. */
+  void migrate();
+
+  std::vector<IPopulation*> m_islands; //!< Stores the populations of the islands.
+  std::vector<GeneticAlgorithm*> m_algorithms; //!< Stores the algorithm evolving each island.
+  std::vector<char> m_running; //!< Stores whether each island needs more generations.
+  ThreadPool *m_threadPool; //!< Stores the threads evolving the islands.
+  int m_generationsMax; //!< Stores the maximum number of generations.
+  int m_populationSize; //!< Stores the population size of each island.
+  int m_currentGeneration; //!< Stores the number of the current generation.
+  int m_seed; //!< Stores the seed from which the seeds of the islands are derived.
+  Topology m_topology; //!< Stores the migration topology.
+  int m_migrationInterval; //!< Stores the number of generations between two migrations.
+  int m_nMigrants; //!< Stores the number of individuals sent by an island to each destination.
+  int m_genomeSize; //!< Stores the number of values per genome.
+  std::vector<double> m_migrantGenomes; //!< Stores the genomes of the migrants of all islands.
+  std::vector<double> m_migrantScores; //!< Stores the scores of the migrants of all islands.
+  std::vector<double> m_incomingGenomes; //!< Stores the genomes of the migrants arriving at an island.
+  std::vector<double> m_incomingScores; //!< Stores the scores of the migrants arriving at an island.
+};
+
+#endif
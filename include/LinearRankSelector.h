@@ -0,0 +1,32 @@
+#ifndef LINEARRANKSELECTOR_H
+#define LINEARRANKSELECTOR_H
+
+#include "IParentSelector.h"
+
+/**
+ * @brief Selects parents with a probability decreasing linearly with their rank.
+ *
+ * The individual at rank \f$k\f$ among \f$n\f$ is selected as first parent with probability
+ * \f[
+ *   P(k) = \frac{n-k}{n(n+1)/2}
+ * \f]
+ * and the second parent follows the same distribution, excluding the first parent.
+ *
+ * This is the default strategy of the populations. Each parent is drawn in constant time
+ * by inverting the cumulative distribution, using a single random number.
+ */
+class LinearRankSelector : public IParentSelector {
+
+public:
+
+  /** Default Constructor */
+  LinearRankSelector();
+
+  /** Destructor */
+  ~LinearRankSelector();
+
+  /** Selects the pairs of parents of several offspring. */
+  void select(int nPairs, int *parents, RandomStream &random);
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MAPPEDDATASET_H
+#define MAPPEDDATASET_H
+
+#include <string>
+#include <stdint.h>
+
+/**
+ * @brief Read-only dataset mapped in memory from a binary file.
+ *
+ * The file stores the points of a dataset by columns, in the layout used by Chi2FitFigureOfMerit:
+ * - A header of kHeaderSize bytes: the magic string "GADATA", the format version, the number of
+ *   dimensions and the number of points.
+ * - One column of doubles per dimension of \f$\vec{x}\f$, followed by the \f$y\f$ and \f$\sigma_y\f$ columns.
+ *   Each column starts at a multiple of kAlignment bytes.
+ *
+ * The values are stored in the native byte order. The file is mapped with mmap() and the columns are
+ * returned as pointers into the mapping: no data is read until it is used, pages are loaded by the
+ * system on demand and shared between the processes mapping the same file, and they do not count as
+ * a copy of the data in the memory of the process.
+ *
+ * The pointers returned by the accessors remain valid until the dataset is closed or destroyed.
+ */
+class MappedDataset {
+
+public:
+
+  /** Default Constructor */
+  MappedDataset();
+
+  /** Constructor mapping a file */
+  MappedDataset(const std::string &path);
+
+  /** Destructor */
+  ~MappedDataset();
+
+  /** Maps a dataset file. */
+  void open(const std::string &path);
+
+  /** Unmaps the dataset file. */
+  void close();
+
+  /** Returns true if a file is mapped. */
+  bool isOpen() const;
+
+  /** Returns the number of points. */
+  long getNPoints() const;
+
+  /** Returns the number of dimensions of \f$\vec{x}\f$. */
+  int getNDimensions() const;
+
+  /** Returns the column of a coordinate of \f$\vec{x}\f$. */
+  const double *getX(int d) const;
+
+  /** Returns the \f$y\f$ column. */
+  const double *getY() const;
+
+  /** Returns the \f$\sigma_y\f$ column. */
+  const double *getEY() const;
+
+  /** Writes a dataset file from columns. */
+  static void write(const std::string &path, long n, int ndim, const double *const *x, const double *y, const double *ey);
+
+  /** Version of the file format. */
+  static const uint32_t kVersion = 1;
+
+  /** Size of the header in bytes. */
+  static const int kHeaderSize = 64;
+
+  /** Alignment of the columns in bytes. */
+  static const int kAlignment = 64;
+
+private:
+
+  /** Copy is forbidden: the mapping is owned. */
+  MappedDataset(const MappedDataset &other);
+
+  /** Assignment is forbidden: the mapping is owned. */
+  MappedDataset &operator=(const MappedDataset &other);
+
+  /** Returns the offset in bytes of a column. */
+  static uint64_t columnOffset(int column, long n);
+
+  void *m_mapping; //!< Stores the address of the mapping, or 0.
+  size_t m_size; //!< Stores the size of the mapping in bytes.
+  long m_npoints; //!< Stores the number of points.
+  int m_ndim; //!< Stores the number of dimensions.
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MODELPOOL_H
+#define MODELPOOL_H
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <typeinfo>
+#include <typeindex>
+
+class IModel;
+
+/**
+ * @brief Recycles model instances across the initializations of populations.
+ *
+ * Populations return their models to a pool when they are cleared (see IPopulation::clear()), and take
+ * models from it when they are initialized, instead of deleting and allocating them. Models are grouped by the
+ * type of the population that created them, such that a population only gets models of the type it creates.
+ * Recycled models keep their resources, e.g. the clone of the formula of a ParametricModel, and are reset by the
+ * population before being used.
+ *
+ * Each population owns a pool. A pool can also be shared by several populations (see IPopulation::setModelPool()),
+ * e.g. to recycle the models of successive fits: it is then safe to use from several threads.
+ * The pool owns the models it holds, and deletes them when it is cleared or destroyed.
+ */
+class ModelPool {
+
+public:
+
+  /** Default Constructor */
+  ModelPool();
+
+  /** Destructor */
+  ~ModelPool();
+
+  /** Takes a model created by a given type of population out of the pool. */
+  IModel *acquire(const std::type_info &owner);
+
+  /** Gives a model created by a given type of population to the pool. */
+  void release(const std::type_info &owner, IModel *model);
+
+  /** Returns the number of models in the pool. */
+  int size();
+
+  /** Deletes all the models in the pool. */
+  void clear();
+
+private:
+
+  /** Copy is forbidden: the models are owned. */
+  ModelPool(const ModelPool &other);
+
+  /** Assignment is forbidden: the models are owned. */
+  ModelPool &operator=(const ModelPool &other);
+
+  std::map<std::type_index, std::vector<IModel*> > m_models; //!< Stores the models, by type of population.
+  std::mutex m_mutex; //!< Protects the models.
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef MULTIPROCESSFIGUREOFMERIT_H
+#define MULTIPROCESSFIGUREOFMERIT_H
+
+#include "IFigureOfMerit.h"
+
+#include <vector>
+#include <sys/types.h>
+
+class IModel;
+
+/**
+ * @brief Figure of merit distributing the evaluation of another figure of merit to worker processes.
+ *
+ * This is useful for expensive figures of merit that are not thread-safe: each worker process holds
+ * its own copy of the wrapped figure of merit. The workers are forked by a spawner process, itself forked
+ * once by startWorkers() before the calling process starts other threads (see startWorkers()).
+ *
+ * When a population computes its scores (see IFigureOfMerit::evaluateBatch()), the models are split
+ * into batches. For each batch, the genomes of the models (see IModel::getGenome()) are sent to an idle
+ * worker over a Unix socket. The worker loads each genome into its copy of a model, evaluates it with
+ * the wrapped figure of merit and sends back the scores.
+ *
+ * A worker that crashes, or does not answer within the timeout (see setTimeout()), is killed and replaced
+ * by a new one, and its batch is sent again. The evaluation fails with an exception if a batch fails too many times.
+ *
+ * Workers are stopped when this object is destroyed. The decisions on the scores (accept(), isBetterThan())
+ * are delegated to the wrapped figure of merit.
+ */
+class MultiProcessFigureOfMerit : public IFigureOfMerit {
+
+public:
+
+  /** Constructor */
+  MultiProcessFigureOfMerit(IFigureOfMerit *fom, int nWorkers);
+
+  /** Destructor */
+  ~MultiProcessFigureOfMerit();
+
+  /** Compute the score of a model in a worker process. */
+  double evaluate(IModel *model) const;
+
+  /** Compute the scores of several models in the worker processes. */
+  void evaluateBatch(IModel *const *models, int n, double *scores) const;
+
+  /** Decide if a model can be accepted as a final answer. */
+  bool accept(IModel *model) const;
+
+  /** Compares two Models */
+  bool isBetterThan(IModel *modelToTest, IModel *referenceModel) const;
+
+  /** Compares two scores */
+  bool isBetterThan(double scoreToTest, double referenceScore) const;
+
+  /** Returns whether models can be ranked using their scores only. */
+  bool ranksOnScore() const;
+
+  /** Sets the number of models sent to a worker at once. */
+  void setBatchSize(int batchSize);
+
+  /** Sets the time after which a worker that did not answer is replaced. */
+  void setTimeout(double seconds);
+
+  /** Sets the number of times a batch is sent again after a failure. */
+  void setMaxRetries(int maxRetries);
+
+  /** Starts the worker processes. */
+  void startWorkers(IModel *prototype);
+
+  /** Stops all worker processes. */
+  void stopWorkers() const;
+
+private:
+
+  /** State of a worker process. */
+  struct Worker {
+    pid_t pid; //!< Process identifier, or -1 if not running.
+    int socket; //!< Socket connected to the worker.
+    int batch; //!< Batch being evaluated by the worker, or -1 if idle.
+    double start; //!< Time at which the batch was sent.
+  };
+
+  /** Starts a worker process. */
+  void startWorker(int w) const;
+
+  /** Kills a worker process. */
+  void killWorker(int w) const;
+
+  /** Kills the workers evaluating a batch, after a failed evaluation. */
+  void abandonBatches() const;
+
+  /** Main loop of the spawner process. */
+  void spawn(int socket, IModel *prototype) const;
+
+  /** Main loop of a worker process. */
+  void serve(int socket, IModel *prototype) const;
+
+  IFigureOfMerit *m_fom; //!< Stores the wrapped figure of merit.
+  int m_batchSize; //!< Stores the number of models per batch (0 for automatic).
+  double m_timeout; //!< Stores the timeout in seconds (0 for none).
+  int m_maxRetries; //!< Stores the number of times a batch is sent again after a failure.
+  int m_genomeSize; //!< Stores the genome size of the prototype of the workers.
+  mutable pid_t m_spawner; //!< Stores the process identifier of the spawner, or -1 if not running.
+  mutable int m_spawnerSocket; //!< Stores the socket connected to the spawner.
+  mutable std::vector<Worker> m_workers; //!< Stores the worker processes.
+  mutable std::vector<double> m_genomes; //!< Stores the genomes to be sent to the workers.
+  mutable std::vector<int> m_batchBegin; //!< Stores the index of the first model of each batch.
+  mutable std::vector<int> m_batchRetries; //!< Stores the number of failures of each batch.
+  mutable std::vector<int> m_pending; //!< Stores the batches waiting for a worker.
+};
+
+#endif
@@ -15,11 +15,18 @@
  *
  * Another desired feature of <a href="https://root.cern.ch/doc/v610/classTF1.html">TF1</a>, 
  * is that it allows plotting 1D and 2D formulas with little extra code.
+ *
+ * A model either owns a clone of the formula holding its parameters (see setFormula()),
+ * or is a lightweight view on parameters stored elsewhere, sharing its formula with other
+ * models (see setView()).
  */
 class ParametricModel : public IModel {
 
 public:
 
+  /** Maximum number of dimensions of the points given to evalBatch(). */
+  static const int kMaxDimensions = 16;
+
   /** Default Constructor */
   ParametricModel();
 
@@ -29,15 +36,52 @@ public:
   /** Sets the formula for this model. */
   void setFormula(TF1 *formula);
 
+  /** Makes this model a view on externally stored parameters. */
+  void setView(TF1 *formula, double *parameters);
+
+  /** Returns whether a clone of a formula describes the same function as another formula. */
+  static bool isSameFunction(const TF1 *clone, const TF1 *formula);
+
   /** Returns the formula for this model. */
   TF1 *getFormula();
   
   /** Returns the formula for this model. */
   const TF1 *getFormula() const;
+
+  /** Returns the number of parameters. */
+  int getNpar() const;
+
+  /** Returns the value of a parameter. */
+  double getParameter(int p) const;
+
+  /** Sets the value of a parameter. */
+  void setParameter(int p, double value);
+
+  /** Returns the values of all parameters. */
+  const double *getParameters() const;
+
+  /** Sets the values of all parameters. */
+  void setParameters(const double *values);
+
+  /** Returns the number of parameters. */
+  virtual int getGenomeSize() const;
+
+  /** Returns the values of all parameters. */
+  virtual const double *getGenome() const;
+
+  /** Sets the values of all parameters. */
+  virtual void setGenome(const double *genome);
+
+  /** Evaluates the function at a given point. */
+  virtual double eval(const double *x) const;
+
+  /** Evaluates the function on a batch of points stored by columns. */
+  virtual void evalBatch(int n, int ndim, const double *const *x, double *fx) const;
   
 protected:
   
   TF1 *m_formula; //!< Holds the formula for this model.
+  double *m_parameters; //!< Points to the parameters if this model is a view, 0 otherwise.
 };
 
 #endif
@@ -5,6 +5,8 @@
 
 #include <TF1.h>
 
+class ParametricModel;
+
 /**
  * @brief Implements a population of parametric models.
  *
@@ -12,12 +14,29 @@
  * - Initialization: parameters are randomly initialized following uniform distribution in the allowed range.
  * - Cross-over: each parameter is passed from either parents chosen at random.
  * - Mutation: a random parameter is chosen and then modified by adding a gaussian noise component.
+ *
+ * Two storage modes are available for the parameters (the genes) of the individuals:
+ * - kFormulaClones: each model owns a clone of the formula holding its parameters.
+ * - kFlatBuffer: the genes of all individuals are stored in a single contiguous array of
+ * \f$n \times n_{par}\f$ values, and models are lightweight views sharing a single clone of the formula.
+ * This avoids creating one ROOT object per individual and keeps cross-over and mutation on contiguous memory.
+ *
+ * Generations are double-buffered: the offspring genes are written to a second array allocated at
+ * initialization, which then becomes the current generation (kFlatBuffer) or is copied to the
+ * formulas (kFormulaClones). Breeding a generation therefore does not allocate memory, and
+ * chunks of offspring can be produced concurrently (see IPopulation::setNThreads()).
  */
 class ParametricModelPopulation : public IPopulation
 {
 
 public:
 
+  /** Storage modes for the parameters of the individuals. */
+  enum GenomeStorage {
+    kFormulaClones, //!< Each model owns a clone of the formula.
+    kFlatBuffer //!< Parameters of all models are stored in a single array.
+  };
+
   /** Default Constructor. */
   ParametricModelPopulation();
 
@@ -29,6 +48,9 @@ public:
 
   /** Sets the relative size (sigma) of the gaussian noise applied during mutation. */
   void setMutationSize(double relativeSize);
+
+  /** Sets the storage mode for the parameters of the individuals. */
+  void setGenomeStorage(GenomeStorage storage);
   
 protected:
 
@@ -36,13 +58,29 @@ protected:
   virtual void doInitialize(int n);
 
   /** Implements cross-over. */
-  virtual void doCrossOver(const std::vector<std::vector<IModel*> > &parents);
+  virtual void doCrossOver(const std::vector<int> &parents, int begin, int end);
+
+  /** Moves the offspring to the current generation. */
+  virtual void doReplaceParents(int begin, int end);
 
   /** Implements mutation. */
-  virtual void doMutate(IModel *model);
+  virtual void doMutate(IModel *model, RandomStream &random);
+
+  /** Cross-over and mutation can be performed concurrently. */
+  virtual bool isBreedingThreadSafe() const;
+
+  /** Creates a new model for this population. */
+  virtual ParametricModel *createModel();
   
   TF1 *m_formula; //!< Stores the formula for this population.
   double m_mutationSize; //!< Stores the relative size (sigma) of the gaussian noise applied during mutation.
+  GenomeStorage m_storage; //!< Stores the storage mode for the parameters of the individuals.
+  TF1 *m_sharedFormula; //!< Stores the clone of the formula shared by all views in kFlatBuffer mode.
+  int m_npar; //!< Stores the number of parameters per individual.
+  std::vector<double> m_parMin; //!< Stores the lower limit of each parameter.
+  std::vector<double> m_parMax; //!< Stores the upper limit of each parameter.
+  std::vector<double> m_genes; //!< Stores the parameters of all individuals in kFlatBuffer mode.
+  std::vector<double> m_offspringGenes; //!< Stores the parameters of the next generation during cross-over.
 };
 
 #endif
@@ -0,0 +1,104 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cmath>
+
+#include "InstrumentationCounters.h"
+
+/**
+ * @brief Counter-based random number generator.
+ *
+ * A stream is identified by a key derived from a seed, a generation, an individual and an operation
+ * (see reset()). The n-th number of the stream is obtained by hashing the key and the counter n with the
+ * SplitMix64 finalizer: it does not depend on any other stream, nor on the order in which streams are used.
+ * This allows the individuals of a population to be bred in any order, or in parallel, with reproducible results.
+ *
+ * The interface follows the one of ROOT's TRandom3 for the methods used in this project.
+ */
+class RandomStream {
+
+public:
+
+  /** Operations of the genetic algorithm, each using separate streams. */
+  enum Operation {
+    kInitialize, //!< Initialization of an individual.
+    kSelection, //!< Selection of the parents of a generation.
+    kCrossOver, //!< Cross-over producing an individual.
+    kMutation, //!< Mutation of an individual.
+    kUser //!< First value available for operations defined by derived classes.
+  };
+
+  /** Constructor */
+  RandomStream(unsigned long long seed=0, unsigned long long generation=0, unsigned long long individual=0, unsigned int operation=0)
+  {
+    reset(seed, generation, individual, operation);
+  }
+
+  /** Moves to the beginning of the stream identified by the given key. */
+  void reset(unsigned long long seed, unsigned long long generation, unsigned long long individual, unsigned int operation)
+  {
+    unsigned long long key = mix(seed + kGamma);
+    key = mix(key ^ (generation + kGamma));
+    key = mix(key ^ (individual + kGamma));
+    key = mix(key ^ (operation + kGamma));
+    m_key = key;
+    m_counter = 0;
+  }
+
+  /** Returns the next 64 random bits of the stream. */
+  unsigned long long next()
+  {
+    InstrumentationCounters::countRandomDraw();
+    return mix(m_key + (++m_counter)*kGamma);
+  }
+
+  /** Returns a random number uniformly distributed in ]0,1[. */
+  double Rndm()
+  {
+    return ((next() >> 11) + 0.5)*(1./9007199254740992.);
+  }
+
+  /** Returns a random number uniformly distributed in ]a,b[. */
+  double Uniform(double a, double b)
+  {
+    return a + (b-a)*Rndm();
+  }
+
+  /** Returns a random integer uniformly distributed in [0,n[. */
+  unsigned int Integer(unsigned int n)
+  {
+    return (unsigned int)(((next() >> 32)*n) >> 32);
+  }
+
+  /** Returns a random number following a gaussian distribution. */
+  double Gaus(double mean=0, double sigma=1)
+  {
+    // Box-Muller transform, discarding the second value such that each call uses two numbers
+    double r = std::sqrt(-2*std::log(Rndm()));
+    return mean + sigma*r*std::cos(6.283185307179586*Rndm());
+  }
+
+  /** Returns the number of values drawn since the beginning of the stream. */
+  unsigned long long getCounter() const
+  {
+    return m_counter;
+  }
+
+private:
+
+  /** Increment of the SplitMix64 generator (golden ratio). */
+  static const unsigned long long kGamma = 0x9E3779B97F4A7C15ULL;
+
+  /** SplitMix64 finalizer. */
+  static unsigned long long mix(unsigned long long z)
+  {
+    z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  unsigned long long m_key; //!< Stores the key identifying the stream.
+  unsigned long long m_counter; //!< Stores the number of values drawn from the stream.
+};
+
+#endif
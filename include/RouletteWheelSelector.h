@@ -0,0 +1,43 @@
+#ifndef ROULETTEWHEELSELECTOR_H
+#define ROULETTEWHEELSELECTOR_H
+
+#include "IParentSelector.h"
+
+/**
+ * @brief Selects parents with a probability proportional to their fitness.
+ *
+ * The fitness of an individual is the distance of its score to the score of the least fitted individual.
+ * An alias table is built once per generation, such that each parent is drawn in constant time.
+ */
+class RouletteWheelSelector : public IParentSelector {
+
+public:
+
+  /** Default Constructor */
+  RouletteWheelSelector();
+
+  /** Destructor */
+  ~RouletteWheelSelector();
+
+  /** Builds the alias table from the scores of a generation. */
+  void prepare(int n, const double *scores);
+
+  /** Selects the pairs of parents of several offspring. */
+  void select(int nPairs, int *parents, RandomStream &random);
+
+  /** Maximum number of draws of the second parent before it is drawn uniformly. */
+  static const int kMaxRetries = 16;
+
+private:
+
+  /** Draws an individual from the alias table. */
+  int draw(RandomStream &random);
+
+  std::vector<double> m_weights; //!< Stores the fitness of the individuals, scaled to a mean of 1.
+  std::vector<double> m_probability; //!< Stores the probability to keep each column of the alias table.
+  std::vector<int> m_alias; //!< Stores the alias of each column of the alias table.
+  std::vector<int> m_small; //!< Work buffer for the construction of the alias table.
+  std::vector<int> m_large; //!< Work buffer for the construction of the alias table.
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SCORERMSTERMINATION_H
+#define SCORERMSTERMINATION_H
+
+#include "ITerminationPolicy.h"
+
+/**
+ * @brief Stops when the scores of the population have converged.
+ *
+ * The RMS of the scores (see IPopulation::getScoreRMS()) relative to the best score measures how far
+ * the population is from having converged to a single solution.
+ */
+class ScoreRMSTermination : public ITerminationPolicy {
+
+public:
+
+  /** Constructor */
+  ScoreRMSTermination(double minRelativeRMS);
+
+  /** Destructor */
+  ~ScoreRMSTermination();
+
+  /** Decides whether the optimization should stop. */
+  bool shouldStop(IPopulation *population, int generation);
+
+private:
+
+  double m_minRelativeRMS; //!< Stores the relative RMS of the scores below which the optimization stops.
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef STAGETIMER_H
+#define STAGETIMER_H
+
+#include <chrono>
+
+/**
+ * @brief Adds the time spent in a scope to a total.
+ *
+ * The timer does nothing if it is given a null total, such that disabled instrumentation only costs a test.
+ */
+class StageTimer {
+
+public:
+
+  /** Starts the timer, if a total is given. */
+  StageTimer(double *total) : m_total(total)
+  {
+    if(m_total) m_start = std::chrono::steady_clock::now();
+  }
+
+  /** Adds the elapsed time in seconds to the total. */
+  ~StageTimer()
+  {
+    if(m_total) *m_total += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+  }
+
+private:
+
+  double *m_total; //!< Stores the total to add the elapsed time to, or 0.
+  std::chrono::steady_clock::time_point m_start; //!< Stores the time at which the timer started.
+};
+
+#endif
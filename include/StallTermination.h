@@ -0,0 +1,36 @@
+#ifndef STALLTERMINATION_H
+#define STALLTERMINATION_H
+
+#include "ITerminationPolicy.h"
+
+/**
+ * @brief Stops when the best score has not improved for a number of generations.
+ *
+ * In steady-state mode, each iteration counts as a generation, such that the number of generations
+ * should be scaled accordingly.
+ */
+class StallTermination : public ITerminationPolicy {
+
+public:
+
+  /** Constructor */
+  StallTermination(int nGenerations, double tolerance=0);
+
+  /** Destructor */
+  ~StallTermination();
+
+  /** Records the initial best score. */
+  void reset(IPopulation *population, int generation);
+
+  /** Decides whether the optimization should stop. */
+  bool shouldStop(IPopulation *population, int generation);
+
+private:
+
+  int m_nGenerations; //!< Stores the number of generations without improvement before stopping.
+  double m_tolerance; //!< Stores the relative improvement below which the best score is considered stalled.
+  double m_bestScore; //!< Stores the best score at the last improvement.
+  int m_lastImprovement; //!< Stores the generation of the last improvement.
+};
+
+#endif
@@ -0,0 +1,418 @@
+#ifndef STATICGENETICALGORITHM_H
+#define STATICGENETICALGORITHM_H
+
+#include "RandomStream.h"
+#include "ThreadPool.h"
+#include "LinearRankSelector.h"
+#include "StaticOperators.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <sstream>
+
+/**
+ * @brief Genetic Algorithm whose operations are composed at compile time.
+ *
+ * GeneticAlgorithm works on the IModel, IFigureOfMerit and IPopulation interfaces: each comparison of the ranking,
+ * each evaluation, cross-over and mutation goes through a virtual call, and the populations cast the models to their
+ * concrete type. This class implements the same algorithm on genomes stored by value, with the operations given as
+ * template parameters, such that the compiler sees the whole generation loop and can inline every operation into it:
+ * - `Genome`: the genes of an individual, copyable, e.g. `std::array<double, N>`.
+ * - `Fitness`: provides `double evaluate(const Genome&) const`, `bool isBetterThan(double, double) const`,
+ * `bool accept(const Genome&, double score) const` and `bool isThreadSafe() const`, e.g. CompiledChi2Fitness. Any IFigureOfMerit
+ * can be used through FigureOfMeritFitness.
+ * - `Selection`: provides `prepare(int n, const double *scores)` and `select(int nPairs, int *parents, RandomStream&)`,
+ * e.g. any IParentSelector, whose calls are resolved statically since it is held by value.
+ * - `Crossover`: provides `int operator()(const Genome&, const Genome&, Genome&, RandomStream&) const`,
+ * returning 1 or 2 if the offspring is identical to the first or second parent, e.g. UniformCrossover.
+ * - `Mutation`: provides `void operator()(Genome&, RandomStream&) const`, e.g. GaussianMutation.
+ *
+ * The algorithm flow is the one of GeneticAlgorithm and ParametricModelPopulation: the best fitted individual is
+ * preserved, the other offspring are crossed-over from parents selected among the ranked population, mutated with
+ * a given rate, and ranked on their scores. Random numbers are drawn from the same streams (see RandomStream):
+ * given the same scores, the default operators breed the same generations as a ParametricModelPopulation.
+ * Offspring identical to one of their parents inherit its score instead of being evaluated.
+ *
+ * Cross-over, mutation and evaluation are fused: each offspring is produced, mutated and evaluated in one pass,
+ * while its genes are in cache. The passes over chunks of the population can run on several threads
+ * (see setNThreads()), provided the fitness is thread-safe.
+ *
+ * Example for the fit of a compiled function:
+ * \code{.cpp}
+ * typedef CompiledChi2Fitness<Gaussian> Fitness;
+ * typedef Fitness::Genome Genome;
+ * StaticGeneticAlgorithm<Genome, Fitness> alg;
+ * alg.setFitness(&fitness);
+ * alg.setMutation(GaussianMutation<Genome>(parMin, parMax, 0.1));
+ * const Genome &best = alg.optimize(UniformInitializer<Genome>(initial, parMin, parMax));
+ * \endcode
+ *
+ * Checkpoints, traces, statistics and termination policies are only available with GeneticAlgorithm.
+ */
+template<class Genome,
+	 class Fitness,
+	 class Selection=LinearRankSelector,
+	 class Crossover=UniformCrossover<Genome>,
+	 class Mutation=GaussianMutation<Genome> >
+class StaticGeneticAlgorithm {
+
+public:
+
+  /** Default Constructor */
+  StaticGeneticAlgorithm();
+
+  /** Destructor */
+  ~StaticGeneticAlgorithm();
+
+  /** Finds the best solution starting from a population created by an initializer. */
+  template<class Initializer> const Genome &optimize(const Initializer &initializer);
+
+  /** Creates and scores the initial population. */
+  template<class Initializer> void initialize(const Initializer &initializer);
+
+  /** Perform one iteration of the optimization loop: creates next generation. */
+  bool nextGeneration();
+
+  /** Returns the current generation number. */
+  int getCurrentGeneration() const { return m_currentGeneration; }
+
+  /** Sets the maximum number of generations before giving up. */
+  void setNGenerationsMax(int generationsMax) { m_generationsMax = generationsMax; }
+
+  /** Sets the population size */
+  void setPopulationSize(int populationSize) { m_populationSize = populationSize; }
+
+  /** Sets the random seed. */
+  void setRandomSeed(int seed) { m_seed = seed; }
+
+  /** Sets the mutation rate. */
+  void setMutateRate(double rate) { m_mutateRate = rate; }
+
+  /** Sets the number of threads used to breed and score the population. */
+  void setNThreads(int nThreads);
+
+  /** Sets the number of individuals per chunk of work distributed to the threads. */
+  void setChunkSize(int chunkSize) { m_chunkSize = chunkSize; }
+
+  /** Sets the fitness used to score and rank the individuals. */
+  void setFitness(const Fitness *fitness) { m_fitness = fitness; }
+
+  /** Sets the selection of the parents. */
+  void setSelection(const Selection &selection) { m_selection = selection; }
+
+  /** Sets the cross-over. */
+  void setCrossover(const Crossover &crossover) { m_crossover = crossover; }
+
+  /** Sets the mutation. */
+  void setMutation(const Mutation &mutation) { m_mutation = mutation; }
+
+  /** Returns the genome at a given rank. */
+  const Genome &getBestFitted(int rank=0) const { return m_genomes[rank]; }
+
+  /** Returns the score at a given rank. */
+  double getScore(int rank=0) const { return m_scores[rank]; }
+
+  /** Returns the size of the population. */
+  int size() const { return m_genomes.size(); }
+
+  /** Returns the mean score for the population. */
+  double getScoreMean() const { return m_scoreMean; }
+
+  /** Returns the RMS of the scores for the population. */
+  double getScoreRMS() const { return m_scoreRMS; }
+
+  /** Returns the number of evaluations since the initialization. */
+  long getNEvaluations() const { return m_nEvaluations; }
+
+private:
+
+  /** Sort key caching the score and the current position of an individual. */
+  struct RankKey {
+    double score; //!< Cached score of the individual.
+    int index; //!< Position of the individual before ranking.
+  };
+
+  /** Orders the keys from the best to the least fitted, ties keeping their order. */
+  struct RankOrder {
+    const Fitness *fitness; //!< The fitness comparing the scores.
+    bool operator()(const RankKey &a, const RankKey &b) const {
+      if(fitness->isBetterThan(a.score, b.score)) return true;
+      if(fitness->isBetterThan(b.score, a.score)) return false;
+      return a.index < b.index;
+    }
+  };
+
+  /** Copy is forbidden: the thread pool is owned. */
+  StaticGeneticAlgorithm(const StaticGeneticAlgorithm &other);
+
+  /** Assignment is forbidden: the thread pool is owned. */
+  StaticGeneticAlgorithm &operator=(const StaticGeneticAlgorithm &other);
+
+  /** Produces, mutates and scores a range of offspring. */
+  void breedRange(int begin, int end);
+
+  /** Scores a range of the initial population. */
+  void scoreRange(int begin, int end);
+
+  /** Runs a task on chunks of the population, on the threads if possible. */
+  template<class Task> void forEachChunk(Task task);
+
+  /** Computes the moments of the scores and ranks the population. */
+  void rank();
+
+  /** Returns the random stream of an individual for a given operation in the current generation. */
+  RandomStream getRandomStream(int individual, int operation) const
+  {
+    return RandomStream(m_seed, m_currentGeneration, individual, operation);
+  }
+
+  const Fitness *m_fitness; //!< Stores the fitness used to score and rank the individuals.
+  Selection m_selection; //!< Holds the selection of the parents.
+  Crossover m_crossover; //!< Holds the cross-over.
+  Mutation m_mutation; //!< Holds the mutation.
+  int m_generationsMax; //!< Stores the maximum number of generations.
+  int m_populationSize; //!< Stores the desired population size.
+  int m_currentGeneration; //!< Stores the number of the current generation, used to derive the random streams.
+  unsigned long long m_seed; //!< Stores the random seed.
+  double m_mutateRate; //!< Stores the mutate rate.
+  ThreadPool *m_threadPool; //!< Stores the pool of threads used to breed and score the population, if any.
+  int m_chunkSize; //!< Stores the number of individuals per chunk of work (0 for automatic).
+  std::vector<Genome> m_genomes; //!< Stores the genomes of the current generation, ranked.
+  std::vector<Genome> m_offspring; //!< Stores the genomes of the next generation during breeding.
+  std::vector<double> m_scores; //!< Stores the scores of the current generation, ranked.
+  std::vector<double> m_offspringScores; //!< Stores the scores of the next generation during breeding.
+  std::vector<int> m_parents; //!< Stores the ranks of the two parents of each offspring.
+  std::vector<int> m_copies; //!< Stores, for each offspring, the rank of the parent whose score it inherits, or -1.
+  std::vector<RankKey> m_rankKeys; //!< Work buffer for the ranking, kept to avoid reallocations.
+  double m_scoreMean; //!< Stores the mean score for the population.
+  double m_scoreRMS; //!< Stores the score RMS for the population.
+  long m_nEvaluations; //!< Stores the number of evaluations since the initialization.
+};
+
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::StaticGeneticAlgorithm()
+{
+  m_fitness = 0;
+  m_generationsMax = 10000;
+  m_populationSize = 100;
+  m_currentGeneration = 0;
+  m_seed = 1234;
+  m_mutateRate = 0.01;
+  m_threadPool = 0;
+  m_chunkSize = 0;
+  m_scoreMean = 0;
+  m_scoreRMS = 0;
+  m_nEvaluations = 0;
+}
+
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::~StaticGeneticAlgorithm()
+{
+  delete m_threadPool;
+}
+
+/**
+ * @param nThreads Number of threads, including the calling thread. 1 disables multi-threading.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+void StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::setNThreads(int nThreads)
+{
+  if(nThreads < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of threads (" << nThreads << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  delete m_threadPool;
+  m_threadPool = 0;
+  if(nThreads > 1) m_threadPool = new ThreadPool(nThreads);
+}
+
+/**
+ * @param initializer Function object initializing a genome: `void operator()(Genome&, RandomStream&) const`.
+ * @return The best fitted genome.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+template<class Initializer>
+const Genome &StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::optimize(const Initializer &initializer)
+{
+  initialize(initializer);
+
+  while(nextGeneration());
+
+  return getBestFitted();
+}
+
+/**
+ * Each individual is initialized from its own random stream, then the population is scored and ranked.
+ * The buffers of the population are allocated here, such that the generations do not allocate memory.
+ *
+ * @param initializer Function object initializing a genome: `void operator()(Genome&, RandomStream&) const`.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+template<class Initializer>
+void StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::initialize(const Initializer &initializer)
+{
+  if(!m_fitness) {
+    throw std::runtime_error("Fitness not assigned for this algorithm.");
+  }
+  if(m_populationSize < 1) {
+    std::ostringstream ostr;
+    ostr << "Population size (" << m_populationSize << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  int n = m_populationSize;
+  m_genomes.resize(n);
+  m_offspring.resize(n);
+  m_scores.resize(n);
+  m_offspringScores.resize(n);
+  m_parents.resize(2*n);
+  m_copies.resize(n);
+  m_rankKeys.resize(n);
+  m_currentGeneration = 0;
+
+  for(int i=0; i<n; i++) {
+    RandomStream random = getRandomStream(i, RandomStream::kInitialize);
+    initializer(m_offspring[i], random);
+    m_copies[i] = -1;
+  }
+  forEachChunk([this](int begin, int end) { scoreRange(begin, end); });
+
+  m_nEvaluations = 0;
+  rank();
+}
+
+/**
+ * @return true if a new generation was created, false if the best fitted individual is accepted
+ * or the maximum number of generations is reached.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+bool StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::nextGeneration()
+{
+  if(m_fitness->accept(m_genomes[0], m_scores[0])) {
+    return false;
+  }
+
+  if(m_currentGeneration > m_generationsMax) {
+    return false;
+  }
+
+  m_currentGeneration++;
+
+  int n = size();
+  m_parents[0] = 0;
+  m_parents[1] = -1;
+  if(n > 1) {
+    m_selection.prepare(n, &m_scores[0]);
+    RandomStream random = getRandomStream(0, RandomStream::kSelection);
+    m_selection.select(n-1, &m_parents[2], random);
+  }
+
+  forEachChunk([this](int begin, int end) { breedRange(begin, end); });
+
+  rank();
+  return true;
+}
+
+/**
+ * The offspring are written to the offspring buffers: the current generation is only read, such that
+ * disjoint ranges can be bred concurrently.
+ *
+ * @param begin Index of the first offspring to be produced.
+ * @param end Index after the last offspring to be produced.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+void StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::breedRange(int begin, int end)
+{
+  const Fitness &fitness = *m_fitness;
+  for(int i=begin; i<end; i++) {
+    Genome &offspring = m_offspring[i];
+    int parent1 = m_parents[2*i];
+    int parent2 = m_parents[2*i+1];
+
+    int copy = -1;
+    if(parent2 < 0) {
+      offspring = m_genomes[parent1];
+      copy = parent1;
+    }else{
+      RandomStream random = getRandomStream(i, RandomStream::kCrossOver);
+      int same = m_crossover(m_genomes[parent1], m_genomes[parent2], offspring, random);
+      if(same == 1) copy = parent1;
+      else if(same == 2) copy = parent2;
+    }
+
+    RandomStream random = getRandomStream(i, RandomStream::kMutation);
+    if(random.Rndm() < m_mutateRate) {
+      m_mutation(offspring, random);
+      copy = -1;
+    }
+
+    m_copies[i] = copy;
+    m_offspringScores[i] = copy >= 0 ? m_scores[copy] : fitness.evaluate(offspring);
+  }
+}
+
+/**
+ * @param begin Index of the first individual to be scored.
+ * @param end Index after the last individual to be scored.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+void StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::scoreRange(int begin, int end)
+{
+  const Fitness &fitness = *m_fitness;
+  for(int i=begin; i<end; i++) {
+    m_offspringScores[i] = fitness.evaluate(m_offspring[i]);
+  }
+}
+
+/**
+ * @param task Function object processing a range of individuals: `void operator()(int begin, int end)`.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+template<class Task>
+void StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::forEachChunk(Task task)
+{
+  if(m_threadPool && m_fitness->isThreadSafe()) {
+    m_threadPool->parallelFor(size(), m_chunkSize, task);
+  }else{
+    task(0, size());
+  }
+}
+
+/**
+ * The offspring become the current generation, ranked from the best to the least fitted.
+ * The moments of the scores are reduced in a fixed order, such that they do not depend on the number of threads.
+ */
+template<class Genome, class Fitness, class Selection, class Crossover, class Mutation>
+void StaticGeneticAlgorithm<Genome, Fitness, Selection, Crossover, Mutation>::rank()
+{
+  int n = size();
+
+  double sum = 0;
+  double sum2 = 0;
+  for(int i=0; i<n; i++) {
+    double score = m_offspringScores[i];
+    sum += score;
+    sum2 += score*score;
+    if(m_copies[i] < 0) m_nEvaluations++;
+    m_rankKeys[i].score = score;
+    m_rankKeys[i].index = i;
+  }
+  m_scoreMean = sum/n;
+  m_scoreRMS = sum2/n - m_scoreMean*m_scoreMean;
+  if(m_scoreRMS<0) m_scoreRMS = 0;
+  m_scoreRMS = std::sqrt(m_scoreRMS);
+
+  RankOrder compare = {m_fitness};
+  std::sort(m_rankKeys.begin(), m_rankKeys.end(), compare);
+
+  for(int i=0; i<n; i++) {
+    int index = m_rankKeys[i].index;
+    m_genomes[i] = m_offspring[index];
+    m_scores[i] = m_offspringScores[index];
+  }
+}
+
+#endif
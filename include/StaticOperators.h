@@ -0,0 +1,136 @@
+#ifndef STATICOPERATORS_H
+#define STATICOPERATORS_H
+
+#include "RandomStream.h"
+
+/**
+ * @file
+ * @brief Genetic operators on parameter genomes, used as policies of StaticGeneticAlgorithm.
+ *
+ * A genome is an array of parameters, e.g. `std::array<double, N>`: any type providing `size()` and `operator[]`.
+ * The operators implement the same behavior as ParametricModelPopulation, and draw the same random numbers
+ * from the same streams, but are called directly on the genomes such that the compiler can inline them.
+ */
+
+/**
+ * @brief Initializes genomes uniformly in the allowed range of each parameter.
+ *
+ * Parameters whose range is empty keep their initial value, like the parameters of the formula
+ * of a ParametricModelPopulation.
+ */
+template<class Genome>
+class UniformInitializer {
+
+public:
+
+  /** Default Constructor: all parameters keep their default value. */
+  UniformInitializer() : m_initial(), m_parMin(), m_parMax() {}
+
+  /** Constructor */
+  UniformInitializer(const Genome &initial, const Genome &parMin, const Genome &parMax)
+    : m_initial(initial), m_parMin(parMin), m_parMax(parMax) {}
+
+  /** Initializes a genome. */
+  void operator()(Genome &genome, RandomStream &random) const;
+
+private:
+
+  Genome m_initial; //!< Stores the initial value of each parameter.
+  Genome m_parMin; //!< Stores the lower limit of each parameter.
+  Genome m_parMax; //!< Stores the upper limit of each parameter.
+};
+
+/**
+ * @brief Cross-over passing each parameter from either parent chosen at random.
+ */
+template<class Genome>
+class UniformCrossover {
+
+public:
+
+  /** Produces an offspring from two parents. */
+  int operator()(const Genome &parent1, const Genome &parent2, Genome &offspring, RandomStream &random) const;
+};
+
+/**
+ * @brief Mutation adding a gaussian noise to a parameter chosen at random.
+ *
+ * The noise has a size relative to the value of the parameter, or an absolute size if the parameter is 0.
+ * Parameters whose range is empty are not mutated.
+ */
+template<class Genome>
+class GaussianMutation {
+
+public:
+
+  /** Default Constructor: no parameter is mutated. */
+  GaussianMutation() : m_parMin(), m_parMax(), m_relativeSize(0.1) {}
+
+  /** Constructor */
+  GaussianMutation(const Genome &parMin, const Genome &parMax, double relativeSize=0.1)
+    : m_parMin(parMin), m_parMax(parMax), m_relativeSize(relativeSize) {}
+
+  /** Sets the relative size (sigma) of the gaussian noise. */
+  void setMutationSize(double relativeSize) { m_relativeSize = relativeSize; }
+
+  /** Mutates a genome. */
+  void operator()(Genome &genome, RandomStream &random) const;
+
+private:
+
+  Genome m_parMin; //!< Stores the lower limit of each parameter.
+  Genome m_parMax; //!< Stores the upper limit of each parameter.
+  double m_relativeSize; //!< Stores the relative size (sigma) of the gaussian noise.
+};
+
+/**
+ * @param genome Genome to be initialized.
+ * @param random Random stream of the individual.
+ */
+template<class Genome>
+void UniformInitializer<Genome>::operator()(Genome &genome, RandomStream &random) const
+{
+  genome = m_initial;
+  for(int p=0; p<(int)genome.size(); p++) {
+    if(m_parMin[p] < m_parMax[p]) {
+      genome[p] = random.Uniform(m_parMin[p], m_parMax[p]);
+    }
+  }
+}
+
+/**
+ * @param parent1 First parent.
+ * @param parent2 Second parent.
+ * @param offspring Returns the offspring.
+ * @param random Random stream of the offspring.
+ * @return 1 if the offspring is identical to the first parent, 2 if it is identical to the second one, 0 otherwise.
+ */
+template<class Genome>
+int UniformCrossover<Genome>::operator()(const Genome &parent1, const Genome &parent2, Genome &offspring, RandomStream &random) const
+{
+  bool same1 = true;
+  bool same2 = true;
+  for(int p=0; p<(int)offspring.size(); p++) {
+    offspring[p] = random.Integer(2) ? parent1[p] : parent2[p];
+    same1 = same1 && offspring[p] == parent1[p];
+    same2 = same2 && offspring[p] == parent2[p];
+  }
+  return same1 ? 1 : same2 ? 2 : 0;
+}
+
+/**
+ * @param genome Genome to be mutated.
+ * @param random Random stream of the individual.
+ */
+template<class Genome>
+void GaussianMutation<Genome>::operator()(Genome &genome, RandomStream &random) const
+{
+  int p = random.Integer(genome.size());
+  if(m_parMin[p] < m_parMax[p]) {
+    double par = genome[p];
+    par += random.Gaus(0, par==0?m_relativeSize:par*m_relativeSize);
+    genome[p] = par;
+  }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef STATSLOGGER_H
+#define STATSLOGGER_H
+
+#include <string>
+#include <fstream>
+
+struct GenerationStats;
+
+/**
+ * @brief Streams the statistics of each generation to a file.
+ *
+ * Two formats are available:
+ * - kCSV: a header line followed by one line per generation.
+ * - kJSON: one JSON object per line and per generation (JSON Lines), such that the file can be read
+ * while it is written, or after an interrupted run.
+ */
+class StatsLogger {
+
+public:
+
+  /** Output formats. */
+  enum Format {
+    kCSV, //!< Comma-separated values.
+    kJSON //!< One JSON object per line.
+  };
+
+  /** Default Constructor. */
+  StatsLogger();
+
+  /** Destructor. */
+  ~StatsLogger();
+
+  /** Opens a file, with the format deduced from its extension. */
+  void open(const std::string &fileName);
+
+  /** Opens a file with the given format. */
+  void open(const std::string &fileName, Format format);
+
+  /** Closes the file. */
+  void close();
+
+  /** Returns whether a file is open. */
+  bool isOpen() const;
+
+  /** Writes the statistics of a generation. */
+  void write(const GenerationStats &stats);
+
+private:
+
+  std::ofstream m_file; //!< Stores the output file.
+  Format m_format; //!< Stores the output format.
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef STOCHASTICUNIVERSALSELECTOR_H
+#define STOCHASTICUNIVERSALSELECTOR_H
+
+#include "IParentSelector.h"
+
+/**
+ * @brief Selects parents proportionally to their fitness using stochastic universal sampling.
+ *
+ * All parents of a generation are selected at once, using equally spaced pointers over the cumulative
+ * fitness: the number of times an individual is selected differs by less than one from its expectation,
+ * which reduces the noise of the selection compared to RouletteWheelSelector.
+ * The selected parents are then shuffled to form the pairs.
+ */
+class StochasticUniversalSelector : public IParentSelector {
+
+public:
+
+  /** Default Constructor */
+  StochasticUniversalSelector();
+
+  /** Destructor */
+  ~StochasticUniversalSelector();
+
+  /** Computes the cumulative fitness from the scores of a generation. */
+  void prepare(int n, const double *scores);
+
+  /** Selects the pairs of parents of several offspring. */
+  void select(int nPairs, int *parents, RandomStream &random);
+
+private:
+
+  std::vector<double> m_weights; //!< Stores the fitness of the individuals, then the cumulative fitness.
+  double m_total; //!< Stores the total fitness.
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+/**
+ * @brief Fixed-size pool of worker threads executing chunked loops.
+ *
+ * The pool is created once and reused: workers sleep between jobs, such that dispatching
+ * a loop does not pay the cost of creating threads.
+ *
+ * A loop over \f$[0, n[\f$ is split in chunks of consecutive indices. Chunks are handed out
+ * dynamically to the workers and to the calling thread, which participates in the work.
+ * The call returns once all chunks are processed. If a chunk throws, the first exception
+ * is rethrown in the calling thread after the loop completed.
+ */
+class ThreadPool {
+
+public:
+
+  /** Constructor */
+  ThreadPool(int nThreads);
+
+  /** Destructor */
+  ~ThreadPool();
+
+  /** Returns the number of threads processing a loop, including the calling thread. */
+  int getNThreads() const;
+
+  /** Processes the range [0, n[ in chunks, and waits for completion. */
+  void parallelFor(int n, int chunkSize, const std::function<void(int, int)> &task);
+
+private:
+
+  /** Main loop of the worker threads. */
+  void work();
+
+  /** Processes chunks of the current loop until none is left. */
+  void runChunks();
+
+  std::vector<std::thread> m_workers; //!< Stores the worker threads.
+  std::mutex m_mutex; //!< Protects the state of the pool.
+  std::condition_variable m_wakeUp; //!< Signals workers that a new loop is available.
+  std::condition_variable m_finished; //!< Signals the calling thread that workers are done.
+  const std::function<void(int, int)> *m_task; //!< Stores the task of the current loop.
+  int m_n; //!< Stores the size of the current loop.
+  int m_chunkSize; //!< Stores the chunk size of the current loop.
+  int m_next; //!< Stores the first index of the next chunk to be processed.
+  int m_busy; //!< Stores the number of workers still processing the current loop.
+  unsigned int m_loop; //!< Stores a counter identifying the current loop.
+  bool m_stop; //!< Stores whether the workers should exit.
+  std::exception_ptr m_error; //!< Stores the first exception thrown by a task.
+};
+
+#endif
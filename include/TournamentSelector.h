@@ -0,0 +1,33 @@
+#ifndef TOURNAMENTSELECTOR_H
+#define TOURNAMENTSELECTOR_H
+
+#include "IParentSelector.h"
+
+/**
+ * @brief Selects each parent as the best fitted of a few individuals drawn at random.
+ *
+ * Larger tournaments increase the selection pressure. With tournaments of two individuals,
+ * the selection probability decreases linearly with the rank, as for LinearRankSelector.
+ */
+class TournamentSelector : public IParentSelector {
+
+public:
+
+  /** Constructor */
+  TournamentSelector(int tournamentSize=2);
+
+  /** Destructor */
+  ~TournamentSelector();
+
+  /** Selects the pairs of parents of several offspring. */
+  void select(int nPairs, int *parents, RandomStream &random);
+
+  /** Sets the number of individuals competing for each selection. */
+  void setTournamentSize(int tournamentSize);
+
+private:
+
+  int m_tournamentSize; //!< Stores the number of individuals competing for each selection.
+};
+
+#endif
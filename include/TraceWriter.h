@@ -0,0 +1,71 @@
+#ifndef TRACEWRITER_H
+#define TRACEWRITER_H
+
+#include "GenerationTrace.h"
+
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * @brief Streams the progress of an optimization to a trace file from a background thread.
+ *
+ * record() appends a row (see GenerationTrace) to a buffer in memory and returns immediately. Once the buffer holds
+ * kBlockSize rows, it is handed over to a background thread that appends it to the file as a block of columns,
+ * while the next rows are recorded into a second buffer. The optimization loop is therefore never delayed by the disk,
+ * and does not allocate memory once both buffers have reached their size.
+ *
+ * The file can be rendered offline, e.g. with the plotTrace utility.
+ */
+class TraceWriter {
+
+public:
+
+  /** Default Constructor */
+  TraceWriter();
+
+  /** Destructor */
+  ~TraceWriter();
+
+  /** Opens a trace file for a given number of parameters. */
+  void open(const std::string &path, int npar);
+
+  /** Writes the remaining rows and closes the file. */
+  void close();
+
+  /** Returns whether a file is open. */
+  bool isOpen() const;
+
+  /** Returns the number of parameters per row. */
+  int getNPar() const;
+
+  /** Records the progress of a generation. */
+  void record(int generation, double best, double mean, double rms, const double *parameters);
+
+  /** Writes the rows recorded so far and waits until they are in the file. */
+  void flush();
+
+  /** Number of rows per block written to the file. */
+  static const int kBlockSize = 256;
+
+private:
+
+  /** Writes the blocks handed over by record() and flush(). */
+  void run();
+
+  std::ofstream m_file; //!< Stores the output file.
+  int m_npar; //!< Stores the number of parameters per row.
+  GenerationTrace m_recording; //!< Stores the rows being recorded.
+  GenerationTrace m_writing; //!< Stores the rows being written.
+  bool m_ready; //!< Stores whether the recorded rows should be written.
+  bool m_busy; //!< Stores whether rows are being written.
+  bool m_stop; //!< Stores whether the thread should stop.
+  std::mutex m_mutex; //!< Protects the state shared with the thread.
+  std::condition_variable m_wakeUp; //!< Signals the thread that rows should be written.
+  std::condition_variable m_done; //!< Signals that rows were written.
+  std::thread m_thread; //!< Stores the writing thread, while a file is open.
+};
+
+#endif
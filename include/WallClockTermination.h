@@ -0,0 +1,35 @@
+#ifndef WALLCLOCKTERMINATION_H
+#define WALLCLOCKTERMINATION_H
+
+#include <chrono>
+#include "ITerminationPolicy.h"
+
+/**
+ * @brief Stops when the optimization has run for a given time.
+ *
+ * The time is measured from the end of the initialization, and checked between generations:
+ * a generation that is started is always completed.
+ */
+class WallClockTermination : public ITerminationPolicy {
+
+public:
+
+  /** Constructor */
+  WallClockTermination(double maxSeconds);
+
+  /** Destructor */
+  ~WallClockTermination();
+
+  /** Records the starting time. */
+  void reset(IPopulation *population, int generation);
+
+  /** Decides whether the optimization should stop. */
+  bool shouldStop(IPopulation *population, int generation);
+
+private:
+
+  double m_maxSeconds; //!< Stores the time budget in seconds.
+  std::chrono::steady_clock::time_point m_start; //!< Stores the starting time.
+};
+
+#endif
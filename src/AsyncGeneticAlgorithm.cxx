@@ -0,0 +1,345 @@
+#include "AsyncGeneticAlgorithm.h"
+#include "IModel.h"
+#include "IFigureOfMerit.h"
+#include "IPopulation.h"
+#include "ITerminationPolicy.h"
+
+#include <TROOT.h>
+
+#include <stdexcept>
+#include <sstream>
+
+AsyncGeneticAlgorithm::AsyncGeneticAlgorithm()
+{
+  m_generationsMax = 10000;
+  m_populationSize = 100;
+  m_currentGeneration = 0;
+  m_batchSize = 10;
+  m_nBatches = 2;
+  m_nWorkers = 1;
+  m_population = 0;
+  m_fom = 0;
+  m_terminationPolicy = 0;
+  m_nRanked = 0;
+  m_stop = false;
+}
+
+AsyncGeneticAlgorithm::~AsyncGeneticAlgorithm()
+{
+  stopWorkers();
+}
+
+/**
+ * @param population Population of models to optimize.
+ * @return Best fitted model after optimization.
+ */
+IModel *AsyncGeneticAlgorithm::optimize(IPopulation *population)
+{
+
+  initialize(population);
+
+  while(nextGeneration());
+
+  finish();
+  
+  return population->getBestFitted();
+}
+
+/**
+ * The population is initialized, scored and ranked, the workers are started, and the first batches
+ * of offspring are bred and queued for evaluation.
+ *
+ * @param population Population of models to optimize.
+ */
+void AsyncGeneticAlgorithm::initialize(IPopulation *population)
+{
+  stopWorkers();
+
+  population->initialize(m_populationSize);
+  population->prepareSteadyState();
+
+  m_population = population;
+  m_fom = population->getFigureOfMerit();
+  m_currentGeneration = 0;
+  m_nRanked = population->size();
+
+  if(m_terminationPolicy) m_terminationPolicy->reset(population, m_currentGeneration);
+
+  // At least one individual should remain to be selected as parent
+  int nBatches = (m_nRanked-1)/m_batchSize;
+  if(nBatches > m_nBatches) nBatches = m_nBatches;
+  if(nBatches < 1) {
+    std::ostringstream ostr;
+    ostr << "Batch size (" << m_batchSize << ") should be smaller than the population size (" << m_nRanked << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  m_batches.resize(nBatches);
+  m_inFlight.clear();
+  m_free.clear();
+  m_queue.clear();
+  for(int b=0; b<nBatches; b++) {
+    m_batches[b].models.reserve(m_batchSize);
+    m_batches[b].scores.reserve(m_batchSize);
+    m_free.push_back(&m_batches[b]);
+  }
+  m_inFlight.reserve(nBatches);
+  m_error = std::exception_ptr();
+
+  startWorkers();
+  while(!m_free.empty()) {
+    submit();
+  }
+}
+
+/**
+ * This function is provided so that the user have the option to control the optimization loop
+ * and possibly execute some code before/after each iteration. The population only contains the individuals
+ * that are not in flight in its ranking: only the best fitted individuals should be accessed in the meantime.
+ * Call finish() to get the whole population back.
+ *
+ * @return `true` if more iterations are needed, `false` if optimal solution has been reached.
+ */
+bool AsyncGeneticAlgorithm::nextGeneration()
+{
+
+  if(m_fom->accept(m_population->getBestFitted())) {
+    return false;
+  }
+    
+  if(m_currentGeneration > m_generationsMax) {
+    return false;
+  }
+
+  if(m_terminationPolicy && m_terminationPolicy->shouldStop(m_population, m_currentGeneration)) {
+    return false;
+  }
+
+  m_currentGeneration++;
+
+  // Resuming after finish(): the pipeline is refilled first
+  if(m_inFlight.empty()) {
+    while(!m_free.empty()) {
+      submit();
+    }
+  }
+
+  collect();
+  submit();
+
+  return true;
+}
+
+/**
+ * After this call, the whole population is ranked again. The optimization can be resumed with nextGeneration(),
+ * which first breeds and queues new batches of offspring, as done at initialization.
+ */
+void AsyncGeneticAlgorithm::finish()
+{
+  while(!m_inFlight.empty()) {
+    collect();
+  }
+}
+
+/**
+ * @return Number of the current iteration.
+ */
+int AsyncGeneticAlgorithm::getCurrentGeneration()
+{
+  return m_currentGeneration;
+}
+
+/**
+ * Each iteration inserts one batch of offspring in the population.
+ *
+ * @param generationsMax Desired maximum number of iterations.
+ */
+void AsyncGeneticAlgorithm::setNGenerationsMax(int generationsMax)
+{
+  m_generationsMax = generationsMax;
+}
+
+/**
+ * @param populationSize Desired population size.
+ */
+void AsyncGeneticAlgorithm::setPopulationSize(int populationSize)
+{
+  m_populationSize = populationSize;
+}
+
+/**
+ * @param batchSize Number of offspring bred and evaluated together, at least 1.
+ */
+void AsyncGeneticAlgorithm::setBatchSize(int batchSize)
+{
+  if(batchSize < 1) {
+    std::ostringstream ostr;
+    ostr << "Batch size (" << batchSize << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_batchSize = batchSize;
+}
+
+/**
+ * More batches in flight keep the workers busy when the evaluation time varies, but reduce
+ * the number of individuals eligible as parents. The number of batches is reduced at initialization
+ * if the population is too small.
+ *
+ * @param nBatches Number of batches in flight, at least 1.
+ */
+void AsyncGeneticAlgorithm::setNBatches(int nBatches)
+{
+  if(nBatches < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of batches (" << nBatches << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_nBatches = nBatches;
+}
+
+/**
+ * The number of workers takes effect at the next initialization.
+ *
+ * @param nWorkers Number of threads evaluating the offspring, at least 1.
+ */
+void AsyncGeneticAlgorithm::setNWorkers(int nWorkers)
+{
+  if(nWorkers < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of workers (" << nWorkers << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_nWorkers = nWorkers;
+}
+
+/**
+ * The policy sees the population with the offspring in flight. It is reset at initialization, and consulted
+ * before each iteration.
+ *
+ * @param policy Policy deciding whether to stop the optimization early, or 0 to only stop on acceptance or
+ * after the maximum number of iterations. The policy is not owned by the algorithm.
+ */
+void AsyncGeneticAlgorithm::setTerminationPolicy(ITerminationPolicy *policy)
+{
+  m_terminationPolicy = policy;
+}
+
+/**
+ * The offspring replace the last individuals of the ranking, and offspring whose score is not found
+ * in the fitness cache are queued for evaluation.
+ */
+void AsyncGeneticAlgorithm::submit()
+{
+  Batch *batch = m_free.back();
+  m_free.pop_back();
+
+  int end = m_nRanked;
+  int begin = end - m_batchSize;
+  m_population->breedOffspring(begin, end);
+  m_population->findUnscored(begin, end, batch->models);
+  batch->scores.resize(batch->models.size());
+  m_nRanked = begin;
+  m_inFlight.insert(m_inFlight.begin(), batch);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(batch->models.empty()) {
+    batch->done = true;
+  }else{
+    batch->done = false;
+    m_queue.push_back(batch);
+    m_wakeUp.notify_one();
+  }
+}
+
+/**
+ * The oldest scored batch is inserted. Batch \f$s\f$ in m_inFlight occupies the individuals starting at
+ * m_nRanked \f$+ s \times\f$ m_batchSize: inserting it moves the more recent batches after it, such that
+ * the positions of the other batches are still given by their order in m_inFlight.
+ */
+void AsyncGeneticAlgorithm::collect()
+{
+  int slot = -1;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(;;) {
+      if(m_error) std::rethrow_exception(m_error);
+      for(int s=m_inFlight.size()-1; s>=0 && slot<0; s--) {
+	if(m_inFlight[s]->done) slot = s;
+      }
+      if(slot >= 0) break;
+      m_completed.wait(lock);
+    }
+  }
+
+  Batch *batch = m_inFlight[slot];
+  if(!batch->models.empty()) {
+    m_population->setScores(&batch->models[0], batch->models.size(), &batch->scores[0]);
+  }
+
+  int begin = m_nRanked + slot*m_batchSize;
+  m_population->insertOffspring(begin, begin + m_batchSize);
+  m_nRanked += m_batchSize;
+
+  m_inFlight.erase(m_inFlight.begin() + slot);
+  m_free.push_back(batch);
+}
+
+void AsyncGeneticAlgorithm::work()
+{
+  for(;;) {
+    Batch *batch = 0;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while(!m_stop && m_queue.empty()) {
+	m_wakeUp.wait(lock);
+      }
+      if(m_stop) return;
+      batch = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    try {
+      m_fom->evaluateBatch(&batch->models[0], batch->models.size(), &batch->scores[0]);
+    }catch(...) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(!m_error) m_error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      batch->done = true;
+    }
+    m_completed.notify_all();
+  }
+}
+
+/**
+ * A single worker is started if the figure of merit is not thread-safe. ROOT's thread-safety is enabled
+ * before starting several workers, since the evaluations may compile formulas concurrently.
+ */
+void AsyncGeneticAlgorithm::startWorkers()
+{
+  m_stop = false;
+  int nWorkers = m_fom->isThreadSafe() ? m_nWorkers : 1;
+  if(nWorkers > 1) ROOT::EnableThreadSafety();
+  for(int i=0; i<nWorkers; i++) {
+    m_workers.push_back(std::thread(&AsyncGeneticAlgorithm::work, this));
+  }
+}
+
+/**
+ * Batches waiting for a worker are abandoned.
+ */
+void AsyncGeneticAlgorithm::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_queue.clear();
+  }
+  m_wakeUp.notify_all();
+  for(unsigned int i=0; i<m_workers.size(); i++) {
+    m_workers[i].join();
+  }
+  m_workers.clear();
+}
@@ -0,0 +1,348 @@
+#include "BatchFitter.h"
+#include "ParametricModel.h"
+#include "ThreadPool.h"
+
+#include <TF1.h>
+
+#include <stdexcept>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <exception>
+
+BatchFitter::BatchFitter()
+{
+  m_formula = 0;
+  m_threadPool = 0;
+  m_populationSize = 100;
+  m_generationsMax = 10000;
+  m_stallGenerations = 0;
+  m_acceptThreshold = 1;
+  m_mutateRate = 0.01;
+  m_mutationSize = 0.1;
+  m_seed = 1234;
+}
+
+BatchFitter::~BatchFitter()
+{
+  deleteContexts();
+  delete m_threadPool;
+}
+
+/**
+ * The formula defines the parameters and their allowed range (see ParametricModelPopulation).
+ * Each thread fits with its own clone of the formula.
+ *
+ * @param formula Model definition shared by all fits. It is not owned by the fitter.
+ */
+void BatchFitter::setFormula(TF1 *formula)
+{
+  m_formula = formula;
+  deleteContexts();
+}
+
+/**
+ * The dataset is copied, such that the arrays can be reused by the caller. The coordinates are stored
+ * by columns, such that the figure of merit wraps the dataset without copying it for each fit.
+ *
+ * @param n Number of points.
+ * @param x Array of the n*ndim coordinates, the coordinates of each point being consecutive.
+ * @param y Array of the n values.
+ * @param ey Array of the n errors on the values.
+ * @param ndim Number of dimensions of the points.
+ * @return Index of the dataset.
+ */
+int BatchFitter::addDataset(int n, const double *x, const double *y, const double *ey, int ndim)
+{
+  if(n < 0 || ndim < 1 || ndim > ParametricModel::kMaxDimensions) {
+    std::ostringstream ostr;
+    ostr << "Invalid dataset of " << n << " points in " << ndim << " dimensions";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  m_datasets.push_back(Dataset());
+  Dataset &dataset = m_datasets.back();
+  dataset.ndim = ndim;
+  dataset.x.resize(n*ndim);
+  for(int j=0; j<n; j++) {
+    for(int d=0; d<ndim; d++) {
+      dataset.x[d*n + j] = x[j*ndim + d];
+    }
+  }
+  dataset.y.assign(y, y + n);
+  dataset.ey.assign(ey, ey + n);
+  return m_datasets.size()-1;
+}
+
+void BatchFitter::clearDatasets()
+{
+  m_datasets.clear();
+  m_results.clear();
+}
+
+/**
+ * @return Number of datasets.
+ */
+int BatchFitter::getNDatasets()
+{
+  return m_datasets.size();
+}
+
+/**
+ * Fits are handed out one at a time to the threads of the pool. A fit throwing an exception does not stop the
+ * other fits: its result is marked as failed, and the first exception thrown is rethrown once all fits are done.
+ */
+void BatchFitter::fit()
+{
+  if(!m_formula) {
+    throw std::runtime_error("No formula has been set for the batch fitter");
+  }
+
+  int nThreads = m_threadPool ? m_threadPool->getNThreads() : 1;
+  createContexts(nThreads);
+
+  m_results.assign(m_datasets.size(), Result());
+  std::exception_ptr error;
+
+  if(m_threadPool) {
+    m_threadPool->parallelFor(m_datasets.size(), 1, [this, &error](int begin, int end) {
+	Context *context;
+	{
+	  std::lock_guard<std::mutex> lock(m_mutex);
+	  context = m_freeContexts.back();
+	  m_freeContexts.pop_back();
+	}
+	for(int i=begin; i<end; i++) {
+	  try {
+	    fitDataset(context, i);
+	  }catch(...) {
+	    std::lock_guard<std::mutex> lock(m_mutex);
+	    m_results[i].failed = true;
+	    if(!error) error = std::current_exception();
+	  }
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_freeContexts.push_back(context);
+      });
+  }else{
+    for(unsigned int i=0; i<m_datasets.size(); i++) {
+      try {
+	fitDataset(m_contexts[0], i);
+      }catch(...) {
+	m_results[i].failed = true;
+	if(!error) error = std::current_exception();
+      }
+    }
+  }
+
+  if(error) std::rethrow_exception(error);
+}
+
+/**
+ * @param i Index of the dataset.
+ * @return Result of the fit of the dataset, once fit() has been called. If the fit failed, only the failed flag
+ * is meaningful.
+ */
+const BatchFitter::Result &BatchFitter::getResult(int i)
+{
+  if(i < 0 || i >= (int)m_results.size()) {
+    std::ostringstream ostr;
+    ostr << "Result (" << i << ") is out of range [" << 0 << ", " << m_results.size() << "[";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  return m_results[i];
+}
+
+/**
+ * The table is written as comma-separated values, with one line per dataset and one column per parameter.
+ * The parameters, score and counters of a failed fit are left empty.
+ *
+ * @param out Output stream.
+ */
+void BatchFitter::printResults(std::ostream &out)
+{
+  out << "dataset";
+  if(m_formula) {
+    for(int p=0; p<m_formula->GetNpar(); p++) {
+      std::string name = m_formula->GetParName(p);
+      if(name.empty()) out << ",p" << p;
+      else out << "," << name;
+    }
+  }
+  out << ",score,generations,nEvaluations,time,failed" << std::endl;
+
+  for(unsigned int i=0; i<m_results.size(); i++) {
+    const Result &result = m_results[i];
+    out << i;
+    if(result.failed) {
+      int nPar = m_formula ? m_formula->GetNpar() : 0;
+      for(int p=0; p<nPar+4; p++) out << ",";
+      out << ",1" << std::endl;
+      continue;
+    }
+    for(unsigned int p=0; p<result.parameters.size(); p++) {
+      out << "," << result.parameters[p];
+    }
+    out << "," << result.score
+	<< "," << result.generations
+	<< "," << result.nEvaluations
+	<< "," << result.time << ",0" << std::endl;
+  }
+}
+
+/**
+ * @param nThreads Number of fits running concurrently, including on the calling thread.
+ */
+void BatchFitter::setNThreads(int nThreads)
+{
+  if(nThreads < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of threads (" << nThreads << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  delete m_threadPool;
+  m_threadPool = 0;
+  if(nThreads > 1) m_threadPool = new ThreadPool(nThreads);
+}
+
+/**
+ * @param populationSize Desired population size.
+ */
+void BatchFitter::setPopulationSize(int populationSize)
+{
+  m_populationSize = populationSize;
+}
+
+/**
+ * @param generationsMax Desired maximum number of generations.
+ */
+void BatchFitter::setNGenerationsMax(int generationsMax)
+{
+  m_generationsMax = generationsMax;
+}
+
+/**
+ * @param stallGenerations Number of generations without improvement of the best score after which a fit stops
+ * (see StallTermination), or 0 to disable.
+ */
+void BatchFitter::setStallGenerations(int stallGenerations)
+{
+  m_stallGenerations = stallGenerations > 0 ? stallGenerations : 0;
+}
+
+/**
+ * @param acceptThreshold Score (\f$\chi^2/ndf\f$) below which a fit stops.
+ */
+void BatchFitter::setAcceptThreshold(double acceptThreshold)
+{
+  m_acceptThreshold = acceptThreshold;
+}
+
+/**
+ * @param rate Desired mutation rate.
+ */
+void BatchFitter::setMutateRate(double rate)
+{
+  m_mutateRate = rate;
+}
+
+/**
+ * @param relativeSize Relative size (sigma) of the gaussian noise applied during mutation.
+ */
+void BatchFitter::setMutationSize(double relativeSize)
+{
+  m_mutationSize = relativeSize;
+}
+
+/**
+ * @param seed Seed from which the seed of each fit is derived.
+ */
+void BatchFitter::setRandomSeed(int seed)
+{
+  m_seed = seed;
+}
+
+/**
+ * Contexts are kept from one call to the next, and only created if the number of threads changed.
+ * The settings are applied to all contexts.
+ *
+ * @param n Number of contexts.
+ */
+void BatchFitter::createContexts(int n)
+{
+  if((int)m_contexts.size() != n) {
+    deleteContexts();
+    for(int i=0; i<n; i++) {
+      Context *context = new Context();
+      context->formula = (TF1*)m_formula->Clone();
+      context->stall = 0;
+      context->population.setFigureOfMerit(&context->fom);
+      context->population.setFormula(context->formula);
+      context->population.setGenomeStorage(ParametricModelPopulation::kFlatBuffer);
+      m_contexts.push_back(context);
+    }
+  }
+
+  m_freeContexts = m_contexts;
+  for(unsigned int i=0; i<m_contexts.size(); i++) {
+    Context *context = m_contexts[i];
+
+    // The limits of the parameters may have changed since the formula was cloned
+    for(int p=0; p<m_formula->GetNpar(); p++) {
+      double pmin, pmax;
+      m_formula->GetParLimits(p, pmin, pmax);
+      context->formula->SetParLimits(p, pmin, pmax);
+      context->formula->SetParameter(p, m_formula->GetParameter(p));
+    }
+
+    context->fom.setAcceptThreshold(m_acceptThreshold);
+    context->population.setMutateRate(m_mutateRate);
+    context->population.setMutationSize(m_mutationSize);
+    context->algorithm.setPopulationSize(m_populationSize);
+    context->algorithm.setNGenerationsMax(m_generationsMax);
+
+    delete context->stall;
+    context->stall = m_stallGenerations > 0 ? new StallTermination(m_stallGenerations) : 0;
+    context->algorithm.setTerminationPolicy(context->stall);
+  }
+}
+
+void BatchFitter::deleteContexts()
+{
+  for(unsigned int i=0; i<m_contexts.size(); i++) {
+    delete m_contexts[i]->stall;
+    m_contexts[i]->population.clear();
+    delete m_contexts[i]->formula;
+    delete m_contexts[i];
+  }
+  m_contexts.clear();
+  m_freeContexts.clear();
+}
+
+/**
+ * @param context Context used for the fit.
+ * @param i Index of the dataset.
+ */
+void BatchFitter::fitDataset(Context *context, int i)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  const Dataset &dataset = m_datasets[i];
+  int n = dataset.y.size();
+  const double *x[ParametricModel::kMaxDimensions];
+  for(int d=0; d<dataset.ndim; d++) {
+    x[d] = dataset.x.data() + d*n;
+  }
+  context->fom.setData(n, dataset.ndim, x, dataset.y.data(), dataset.ey.data());
+
+  context->population.setRandomSeed(m_seed + i);
+  context->population.resetCacheCounters();
+  ParametricModel *best = dynamic_cast<ParametricModel*>(context->algorithm.optimize(&context->population));
+
+  Result &result = m_results[i];
+  result.parameters.assign(best->getParameters(), best->getParameters() + best->getNpar());
+  result.score = best->getScore();
+  result.generations = context->algorithm.getCurrentGeneration();
+  result.nEvaluations = context->population.getCacheMisses();
+  result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,245 @@
+#include "Checkpoint.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+const uint32_t Checkpoint::kVersion;
+
+namespace {
+
+  /** Magic string identifying a checkpoint file. */
+  const char kMagic[8] = {'G', 'A', 'C', 'K', 'P', 'T', 0, 0};
+
+  /** Returns the FNV-1a hash of a buffer. */
+  uint64_t checksum(const char *data, size_t size)
+  {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for(size_t i=0; i<size; i++) {
+      hash ^= (unsigned char)data[i];
+      hash *= 0x100000001B3ULL;
+    }
+    return hash;
+  }
+
+  /** Writes a buffer to a file and flushes it to the storage. Returns false on failure. */
+  bool writeFile(const std::string &path, const std::vector<char> &buffer)
+  {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) return false;
+    const char *data = buffer.data();
+    size_t remaining = buffer.size();
+    while(remaining > 0) {
+      ssize_t n = ::write(fd, data, remaining);
+      if(n < 0 && errno == EINTR) continue;
+      if(n <= 0) {
+	close(fd);
+	return false;
+      }
+      data += n;
+      remaining -= n;
+    }
+    bool ok = fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+  }
+
+  /** Flushes the entries of the directory of a file to the storage, where possible. */
+  void syncDirectory(const std::string &path)
+  {
+    size_t slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if(fd < 0) return;
+    fsync(fd);
+    close(fd);
+  }
+
+  /** Appends values to a buffer. */
+  template<class T> void put(std::vector<char> &buffer, const T *values, size_t n)
+  {
+    const char *bytes = (const char*)values;
+    buffer.insert(buffer.end(), bytes, bytes + n*sizeof(T));
+  }
+
+  /** Appends a value to a buffer. */
+  template<class T> void put(std::vector<char> &buffer, const T &value)
+  {
+    put(buffer, &value, 1);
+  }
+
+  /**
+   * @brief Reads values from a buffer, checking its bounds.
+   */
+  class Reader {
+  public:
+    Reader(const std::vector<char> &buffer, size_t size, const std::string &path) :
+      m_buffer(buffer), m_size(size), m_position(0), m_path(path) {}
+    template<class T> void get(T *values, size_t n) {
+      check(n*sizeof(T));
+      memcpy(values, m_buffer.data() + m_position, n*sizeof(T));
+      m_position += n*sizeof(T);
+    }
+    template<class T> void get(T &value) {
+      get(&value, 1);
+    }
+    template<class T> void get(std::vector<T> &values, size_t n) {
+      check(n*sizeof(T));
+      values.resize(n);
+      get(values.data(), n);
+    }
+  private:
+    void check(size_t bytes) {
+      if(bytes > m_size - m_position) {
+	std::ostringstream ostr;
+	ostr << "Checkpoint " << m_path << " is truncated";
+	throw std::runtime_error(ostr.str().c_str());
+      }
+    }
+    const std::vector<char> &m_buffer;
+    size_t m_size;
+    size_t m_position;
+    std::string m_path;
+  };
+
+}
+
+Checkpoint::Checkpoint()
+{
+  generation = 0;
+  seed = 0;
+  populationGeneration = 0;
+  size = 0;
+  genomeSize = 0;
+  nRanked = 0;
+  rankedScoresValid = false;
+  scoreSum = 0;
+  scoreSum2 = 0;
+  scoreMean = 0;
+  scoreRMS = 0;
+  cacheHits = 0;
+  cacheMisses = 0;
+}
+
+/**
+ * The file is first written under a temporary name and flushed to the storage, then renamed, such that
+ * an interrupted write or a system crash never replaces a valid checkpoint with a truncated one.
+ * The directory is flushed after the rename, such that the new checkpoint survives a crash.
+ * Throws an exception if the file cannot be written.
+ *
+ * @param path Path of the checkpoint file, which is overwritten.
+ */
+void Checkpoint::write(const std::string &path) const
+{
+  std::vector<char> buffer;
+  buffer.reserve(128 + genomes.size()*sizeof(double) + scores.size()*(2*sizeof(double)+1));
+  put(buffer, kMagic, sizeof(kMagic));
+  put(buffer, kVersion);
+  put(buffer, (int32_t)generation);
+  put(buffer, seed);
+  put(buffer, populationGeneration);
+  put(buffer, (int32_t)size);
+  put(buffer, (int32_t)genomeSize);
+  put(buffer, (int32_t)nRanked);
+  put(buffer, (char)rankedScoresValid);
+  put(buffer, scoreSum);
+  put(buffer, scoreSum2);
+  put(buffer, scoreMean);
+  put(buffer, scoreRMS);
+  put(buffer, cacheHits);
+  put(buffer, cacheMisses);
+  put(buffer, genomes.data(), (size_t)size*genomeSize);
+  put(buffer, scores.data(), size);
+  put(buffer, dirty.data(), size);
+  if(rankedScoresValid) put(buffer, parentScores.data(), size);
+  put(buffer, checksum(buffer.data(), buffer.size()));
+
+  std::string temporary = path + ".tmp";
+  if(!writeFile(temporary, buffer) || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::ostringstream ostr;
+    ostr << "Failed to write checkpoint " << path;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  syncDirectory(path);
+}
+
+/**
+ * Throws an exception if the file cannot be read, or is not a valid checkpoint.
+ *
+ * @param path Path of the checkpoint file.
+ */
+void Checkpoint::read(const std::string &path)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if(!in) {
+    std::ostringstream ostr;
+    ostr << "Failed to open checkpoint " << path;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  std::vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  uint64_t sum;
+  if(buffer.size() < sizeof(kMagic) + sizeof(kVersion) + sizeof(sum) || memcmp(buffer.data(), kMagic, sizeof(kMagic)) != 0) {
+    std::ostringstream ostr;
+    ostr << "File " << path << " is not a checkpoint";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  size_t contentSize = buffer.size() - sizeof(sum);
+  memcpy(&sum, buffer.data() + contentSize, sizeof(sum));
+  if(sum != checksum(buffer.data(), contentSize)) {
+    std::ostringstream ostr;
+    ostr << "Checkpoint " << path << " is corrupted";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  Reader reader(buffer, contentSize, path);
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  reader.get(magic, sizeof(magic));
+  reader.get(version);
+  if(version != kVersion) {
+    std::ostringstream ostr;
+    ostr << "Checkpoint " << path << " has version " << version << ", expected " << kVersion;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  int32_t value;
+  char flag;
+  reader.get(value);
+  generation = value;
+  reader.get(seed);
+  reader.get(populationGeneration);
+  reader.get(value);
+  size = value;
+  reader.get(value);
+  genomeSize = value;
+  reader.get(value);
+  nRanked = value;
+  reader.get(flag);
+  rankedScoresValid = flag;
+  reader.get(scoreSum);
+  reader.get(scoreSum2);
+  reader.get(scoreMean);
+  reader.get(scoreRMS);
+  reader.get(cacheHits);
+  reader.get(cacheMisses);
+  if(size < 0 || genomeSize < 0 || nRanked < 0 || nRanked > size) {
+    std::ostringstream ostr;
+    ostr << "Checkpoint " << path << " is corrupted";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  reader.get(genomes, (size_t)size*genomeSize);
+  reader.get(scores, size);
+  reader.get(dirty, size);
+  if(rankedScoresValid) {
+    reader.get(parentScores, size);
+  }else{
+    parentScores.clear();
+  }
+}
@@ -0,0 +1,113 @@
+#include "CheckpointWriter.h"
+
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @param path Path of the checkpoint file, which is overwritten by each checkpoint.
+ */
+CheckpointWriter::CheckpointWriter(const std::string &path)
+{
+  m_path = path;
+  m_hasPending = false;
+  m_busy = false;
+  m_stop = false;
+  m_nWritten = 0;
+  m_thread = std::thread(&CheckpointWriter::run, this);
+}
+
+/**
+ * The pending checkpoint, if any, is written before the thread stops.
+ */
+CheckpointWriter::~CheckpointWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  m_thread.join();
+}
+
+/**
+ * The checkpoint is copied into a buffer reused from one call to the next. A pending checkpoint that
+ * was not written yet is replaced.
+ * Throws an exception if writing a previous checkpoint failed.
+ *
+ * @param checkpoint Checkpoint to be written.
+ */
+void CheckpointWriter::submit(const Checkpoint &checkpoint)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_error.empty()) {
+      std::string error = m_error;
+      m_error.clear();
+      throw std::runtime_error(error.c_str());
+    }
+    m_pending = checkpoint;
+    m_hasPending = true;
+  }
+  m_wakeUp.notify_all();
+}
+
+/**
+ * Throws an exception if writing a checkpoint failed.
+ */
+void CheckpointWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_done.wait(lock, [this]() { return !m_hasPending && !m_busy; });
+  if(!m_error.empty()) {
+    std::string error = m_error;
+    m_error.clear();
+    throw std::runtime_error(error.c_str());
+  }
+}
+
+/**
+ * @return Number of checkpoints written to the file.
+ */
+int CheckpointWriter::getNWritten()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nWritten;
+}
+
+/**
+ * @return Path of the checkpoint file.
+ */
+const std::string &CheckpointWriter::getPath() const
+{
+  return m_path;
+}
+
+void CheckpointWriter::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(true) {
+    m_wakeUp.wait(lock, [this]() { return m_hasPending || m_stop; });
+    if(!m_hasPending) break;
+
+    std::swap(m_pending, m_writing);
+    m_hasPending = false;
+    m_busy = true;
+    lock.unlock();
+
+    std::string error;
+    try {
+      m_writing.write(m_path);
+    }catch(const std::exception &e) {
+      error = e.what();
+    }
+
+    lock.lock();
+    m_busy = false;
+    if(error.empty()) {
+      m_nWritten++;
+    }else{
+      m_error = error;
+    }
+    m_done.notify_all();
+  }
+}
@@ -1,14 +1,32 @@
 #include "Chi2FitFigureOfMerit.h"
 
 #include "ParametricModel.h"
+#include "MappedDataset.h"
+
+#include <TH1.h>
+#include <TGraphErrors.h>
+#include <TArrayD.h>
 
 #include <stdexcept>
+#include <sstream>
+#include <limits>
+#include <cmath>
+
+const int Chi2FitFigureOfMerit::kBatchSize;
+const int Chi2FitFigureOfMerit::kModelBlockSize;
 
 
 Chi2FitFigureOfMerit::Chi2FitFigureOfMerit() :
   IFigureOfMerit()
 {
   setAcceptThreshold(0.1);
+  m_npoints = 0;
+  m_y = 0;
+  m_error = 0;
+  m_mask = 0;
+  m_errorIsVariance = false;
+  m_isOwned = true;
+  m_ndf = 0;
 }
 
 Chi2FitFigureOfMerit::~Chi2FitFigureOfMerit()
@@ -16,22 +34,252 @@ Chi2FitFigureOfMerit::~Chi2FitFigureOfMerit()
 }
 
 /**
+ * All points should have the same number of dimensions.
+ * Points with \f$y=0\f$ are ignored in the \f$\chi^2\f$ calculation.
+ * Points can not be added to wrapped data (see setData()): call clearData() first.
+ *
  * @param x \f$\vec{x}\f$ coordinate.
  * @param y \f$y\f$ coordinate.
  * @param ey \f$\sigma_y\f$ error on \f$y\f$ coordinate.
  */
 void Chi2FitFigureOfMerit::addData(const std::vector<double> &x, double y, double ey)
 {
-  m_x.push_back(x);
-  m_y.push_back(y);
-  m_ey.push_back(ey);
+  if(!m_isOwned) {
+    throw std::runtime_error("Can not add points to wrapped data");
+  }
+  
+  if(m_yData.empty()) {
+    if(x.size() > (unsigned int)ParametricModel::kMaxDimensions) {
+      std::ostringstream ostr;
+      ostr << "Number of dimensions (" << x.size() << ") exceeds the maximum (" << ParametricModel::kMaxDimensions << ")";
+      throw std::runtime_error(ostr.str().c_str());
+    }
+    m_xData.resize(x.size());
+  }else if(x.size() != m_xData.size()) {
+    std::ostringstream ostr;
+    ostr << "Number of dimensions (" << x.size() << ") differs from previous data points (" << m_xData.size() << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  for(unsigned int d=0; d<x.size(); d++) {
+    m_xData[d].push_back(x[d]);
+  }
+  m_yData.push_back(y);
+  m_errorData.push_back(ey);
+  if(y != 0) {
+    m_ndf++;
+  }
+  useOwnedData();
+}
+
+/**
+ * The arrays are not copied: they must remain valid, and must not be modified, until the data is
+ * cleared or replaced. Any previous data is cleared.
+ * Points with \f$y=0\f$ are ignored in the \f$\chi^2\f$ calculation.
+ *
+ * @param n Number of points.
+ * @param ndim Number of dimensions of \f$\vec{x}\f$.
+ * @param x Array of ndim arrays of n coordinates, one per dimension.
+ * @param y Array of the n \f$y\f$ coordinates.
+ * @param ey Array of the n \f$\sigma_y\f$ errors on \f$y\f$.
+ */
+void Chi2FitFigureOfMerit::setData(int n, int ndim, const double *const *x, const double *y, const double *ey)
+{
+  clearData();
+  m_x.assign(x, x + ndim);
+  m_y = y;
+  m_error = ey;
+  setColumns(n, ndim);
+}
+
+/**
+ * The points are the centers of the bins, without the underflow and overflow bins. The errors are those returned by
+ * TH1::GetBinError() with the default error option: \f$\sqrt{\sum w^2}\f$ if the sum of the squares of the weights
+ * is stored, or \f$\sqrt{|y|}\f$ otherwise, such that bins with negative contents keep a positive weight.
+ *
+ * For histograms storing double precision contents (TH1D, TH2D, TH3D), the contents and the sums of the squares of the
+ * weights are wrapped without copy, and the histogram must remain valid, and must not be modified, until the data is
+ * cleared or replaced. For other histograms, the contents are copied. The coordinates of the bin centers are not stored by
+ * the histogram and are always computed. For histograms with more than one dimension, the underflow and overflow bins
+ * lying between the first and last bins are flagged to be ignored.
+ * Bins with \f$y=0\f$ are ignored in the \f$\chi^2\f$ calculation.
+ *
+ * @param hist Histogram to be fitted.
+ */
+void Chi2FitFigureOfMerit::setData(const TH1 *hist)
+{
+  clearData();
+
+  int ndim = hist->GetDimension();
+  const TAxis *axes[3] = {hist->GetXaxis(), hist->GetYaxis(), hist->GetZaxis()};
+  int nbins[3] = {hist->GetNbinsX(), hist->GetNbinsY(), hist->GetNbinsZ()};
+  int first = hist->GetBin(1, 1, 1);
+  int last = hist->GetBin(nbins[0], nbins[1], nbins[2]);
+  int n = last - first + 1;
+
+  m_xData.resize(ndim);
+  for(int d=0; d<ndim; d++) {
+    m_xData[d].resize(n);
+  }
+  if(ndim > 1) {
+    m_maskData.resize(n);
+  }
+  for(int i=0; i<n; i++) {
+    int bins[3];
+    hist->GetBinXYZ(first+i, bins[0], bins[1], bins[2]);
+    bool inRange = true;
+    for(int d=0; d<ndim; d++) {
+      m_xData[d][i] = axes[d]->GetBinCenter(bins[d]);
+      inRange = inRange && bins[d] >= 1 && bins[d] <= nbins[d];
+    }
+    if(ndim > 1) {
+      m_maskData[i] = inRange;
+    }
+  }
+
+  const TArrayD *contents = dynamic_cast<const TArrayD*>(hist);
+  if(contents) {
+    m_y = contents->GetArray() + first;
+  }else{
+    m_yData.resize(n);
+    for(int i=0; i<n; i++) {
+      m_yData[i] = hist->GetBinContent(first+i);
+    }
+    m_y = m_yData.data();
+  }
+  m_error = hist->GetSumw2N() > 0 ? hist->GetSumw2()->GetArray() + first : m_y;
+  m_errorIsVariance = true;
+
+  for(int d=0; d<ndim; d++) {
+    m_x.push_back(m_xData[d].data());
+  }
+  m_mask = ndim > 1 ? m_maskData.data() : 0;
+  setColumns(n, ndim);
+}
+
+/**
+ * The arrays of the graph are not copied: the graph must remain valid, and must not be modified, until the data is
+ * cleared or replaced.
+ * Points with \f$y=0\f$ are ignored in the \f$\chi^2\f$ calculation.
+ *
+ * @param graph Graph to be fitted.
+ */
+void Chi2FitFigureOfMerit::setData(const TGraphErrors *graph)
+{
+  const double *x = graph->GetX();
+  setData(graph->GetN(), 1, &x, graph->GetY(), graph->GetEY());
+}
+
+/**
+ * The columns are read directly from the mapping: the dataset must remain open until the data is
+ * cleared or replaced.
+ * Points with \f$y=0\f$ are ignored in the \f$\chi^2\f$ calculation.
+ *
+ * @param dataset Dataset to be fitted.
+ */
+void Chi2FitFigureOfMerit::setData(const MappedDataset &dataset)
+{
+  if(dataset.getNPoints() > std::numeric_limits<int>::max()) {
+    std::ostringstream ostr;
+    ostr << "Number of points (" << dataset.getNPoints() << ") exceeds the maximum (" << std::numeric_limits<int>::max() << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  std::vector<const double*> x(dataset.getNDimensions());
+  for(int d=0; d<dataset.getNDimensions(); d++) {
+    x[d] = dataset.getX(d);
+  }
+  setData(dataset.getNPoints(), x.size(), x.data(), dataset.getY(), dataset.getEY());
 }
 
+/**
+ * @return Number of data points, including the ignored ones.
+ */
+int Chi2FitFigureOfMerit::getNPoints() const
+{
+  return m_npoints;
+}
+
+/**
+ * Wrapped data is detached. The memory of the owned data is kept to be reused.
+ */
 void Chi2FitFigureOfMerit::clearData()
 {
+  m_xData.clear();
+  m_yData.clear();
+  m_errorData.clear();
+  m_maskData.clear();
   m_x.clear();
-  m_y.clear();
-  m_ey.clear();
+  m_y = 0;
+  m_error = 0;
+  m_mask = 0;
+  m_errorIsVariance = false;
+  m_isOwned = true;
+  m_npoints = 0;
+  m_ndf = 0;
+}
+
+void Chi2FitFigureOfMerit::useOwnedData()
+{
+  m_x.resize(m_xData.size());
+  for(unsigned int d=0; d<m_xData.size(); d++) {
+    m_x[d] = m_xData[d].data();
+  }
+  m_y = m_yData.data();
+  m_error = m_errorData.data();
+  m_npoints = m_yData.size();
+}
+
+/**
+ * Called once the columns are set by setData(): the data is not owned anymore, even if some columns
+ * are computed and stored in the owned arrays.
+ *
+ * @param n Number of points.
+ * @param ndim Number of dimensions of \f$\vec{x}\f$.
+ */
+void Chi2FitFigureOfMerit::setColumns(int n, int ndim)
+{
+  if(ndim > ParametricModel::kMaxDimensions) {
+    std::ostringstream ostr;
+    ostr << "Number of dimensions (" << ndim << ") exceeds the maximum (" << ParametricModel::kMaxDimensions << ")";
+    clearData();
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  
+  m_npoints = n;
+  m_isOwned = false;
+  m_ndf = 0;
+  for(int i=0; i<n; i++) {
+    if(m_y[i] != 0 && (!m_mask || m_mask[i])) m_ndf++;
+  }
+}
+
+/**
+ * The weight of a point is \f$1/\sigma_y^2\f$, or 0 for points that are ignored. Variances are taken in absolute value,
+ * since the contents of a histogram without the sums of the squares of the weights are used as variances.
+ *
+ * @param begin Index of the first point.
+ * @param n Number of points.
+ * @param weight Array of n weights to be filled.
+ */
+void Chi2FitFigureOfMerit::computeWeights(int begin, int n, double *weight) const
+{
+  const double *y = m_y + begin;
+  const double *error = m_error + begin;
+  if(m_errorIsVariance) {
+    for(int i=0; i<n; i++) {
+      weight[i] = y[i] != 0 ? 1./std::fabs(error[i]) : 0;
+    }
+  }else{
+    for(int i=0; i<n; i++) {
+      weight[i] = y[i] != 0 ? 1./(error[i]*error[i]) : 0;
+    }
+  }
+  if(m_mask) {
+    const unsigned char *mask = m_mask + begin;
+    for(int i=0; i<n; i++) {
+      if(!mask[i]) weight[i] = 0;
+    }
+  }
 }
 
 /**
@@ -45,27 +293,81 @@ void Chi2FitFigureOfMerit::clearData()
  */
 double Chi2FitFigureOfMerit::evaluate(IModel *imodel) const
 {
+  double score;
+  evaluateBatch(&imodel, 1, &score);
+  return score;
+}
 
-  ParametricModel *model = dynamic_cast<ParametricModel*>(imodel);
-  if(!model) {
-    throw std::runtime_error("Given model is not a parametric model");
-  }
-  
-  if(m_x.size() == 0) return 0;
+/**
+ * Models are processed in blocks of kModelBlockSize. For each block, the data is traversed once:
+ * each batch of points is evaluated for all the models of the block while it is in cache.
+ * The scores are identical to those returned by evaluate().
+ *
+ * @param models Array of models to be evaluated.
+ * @param n Number of models.
+ * @param scores Array of n \f$\chi^2/ndf\f$ scores to be filled.
+ */
+void Chi2FitFigureOfMerit::evaluateBatch(IModel *const *models, int n, double *scores) const
+{
+
+  const ParametricModel *block[kModelBlockSize];
+  double chi2[kModelBlockSize];
+
+  int npoints = m_npoints;
+  int ndim = m_x.size();
+  const double *y = m_y;
+  const double *x[ParametricModel::kMaxDimensions];
+  double fx[kBatchSize];
+  double weight[kBatchSize];
+
+  for(int first=0; first<n; first+=kModelBlockSize) {
+    int nmodels = n-first < kModelBlockSize ? n-first : kModelBlockSize;
+    for(int m=0; m<nmodels; m++) {
+      block[m] = dynamic_cast<ParametricModel*>(models[first+m]);
+      if(!block[m]) {
+	throw std::runtime_error("Given model is not a parametric model");
+      }
+      chi2[m] = 0;
+    }
+
+    if(npoints == 0) {
+      for(int m=0; m<nmodels; m++) scores[first+m] = 0;
+      continue;
+    }
+    
+    for(int begin=0; begin<npoints; begin+=kBatchSize) {
+      int nb = npoints-begin < kBatchSize ? npoints-begin : kBatchSize;
+      for(int d=0; d<ndim; d++) x[d] = m_x[d] + begin;
+      computeWeights(begin, nb, weight);
+      for(int m=0; m<nmodels; m++) {
+	block[m]->evalBatch(nb, ndim, x, fx);
+	double sum = chi2[m];
+	for(int i=0; i<nb; i++) {
+	  double r = fx[i] - y[begin+i];
+	  double w = weight[i];
+	  sum += w != 0 ? r*r*w : 0;
+	}
+	chi2[m] = sum;
+      }
+    }
 
-  double chi2 = 0;
-  int ndf = 0;
-  for(unsigned int i=0; i<m_x.size(); i++) {
-    double y = m_y[i];
-    if(y == 0) continue;
-    const std::vector<double> &x = m_x[i];
-    double ey = m_ey[i];
-    double fx = model->getFormula()->EvalPar(x.data());
-    chi2 += (fx - y)*(fx - y)/(ey*ey);
-    ndf++;
+    for(int m=0; m<nmodels; m++) {
+      scores[first+m] = chi2[m] / m_ndf;
+    }
   }
+}
 
-  return chi2 / ndf;
+/**
+ * The data is only read during the evaluation, and models are evaluated with explicit parameters
+ * without modifying their formula, such that different models can be evaluated concurrently. Formulas are however prepared lazily by
+ * ROOT's interpreter on first use: this preparation is serialized by ROOT's thread-safety, which is enabled
+ * when the threads are created (see ThreadPool).
+ *
+ * @return true
+ */
+bool Chi2FitFigureOfMerit::isThreadSafe() const
+{
+  return true;
 }
 
 /**
@@ -0,0 +1,55 @@
+#include "CombinedTermination.h"
+
+/**
+ * @param mode Combination mode.
+ */
+CombinedTermination::CombinedTermination(Mode mode) :
+  ITerminationPolicy()
+{
+  m_mode = mode;
+}
+
+CombinedTermination::~CombinedTermination()
+{
+}
+
+/**
+ * @param policy Policy to add. It is not owned by the combination.
+ */
+void CombinedTermination::add(ITerminationPolicy *policy)
+{
+  m_policies.push_back(policy);
+}
+
+/**
+ * @param population Population being optimized, initialized and scored.
+ * @param generation Number of the generation the optimization starts from, 0 unless resuming.
+ */
+void CombinedTermination::reset(IPopulation *population, int generation)
+{
+  for(unsigned int i=0; i<m_policies.size(); i++) {
+    m_policies[i]->reset(population, generation);
+  }
+}
+
+/**
+ * All policies are evaluated at each generation, such that those tracking the progress of the optimization
+ * (e.g. StallTermination) stay up to date. An empty combination never stops.
+ *
+ * @param population Population being optimized.
+ * @param generation Number of the last generation.
+ * @return `true` if the combination of the policies tells to stop.
+ */
+bool CombinedTermination::shouldStop(IPopulation *population, int generation)
+{
+  if(m_policies.empty()) return false;
+
+  bool any = false;
+  bool all = true;
+  for(unsigned int i=0; i<m_policies.size(); i++) {
+    bool stop = m_policies[i]->shouldStop(population, generation);
+    any = any || stop;
+    all = all && stop;
+  }
+  return m_mode == kAny ? any : all;
+}
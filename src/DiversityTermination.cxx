@@ -0,0 +1,101 @@
+#include "DiversityTermination.h"
+#include "IPopulation.h"
+#include "IModel.h"
+
+#include <cmath>
+
+/**
+ * @param minDiversity Diversity, relative to the initial population, below which the optimization stops.
+ */
+DiversityTermination::DiversityTermination(double minDiversity) :
+  ITerminationPolicy()
+{
+  m_minDiversity = minDiversity;
+  m_diversity = 1;
+}
+
+DiversityTermination::~DiversityTermination()
+{
+}
+
+/**
+ * @param population Population being optimized, initialized and scored.
+ * @param generation Number of the generation the optimization starts from, 0 unless resuming.
+ */
+void DiversityTermination::reset(IPopulation *population, int generation)
+{
+  computeSpread(population, m_initialSpread);
+  m_diversity = 1;
+}
+
+/**
+ * Genes that had no spread in the initial population are ignored.
+ *
+ * @param population Population being optimized.
+ * @param generation Number of the last generation.
+ * @return `true` if the diversity is below the minimum.
+ */
+bool DiversityTermination::shouldStop(IPopulation *population, int generation)
+{
+  int genomeSize = computeSpread(population, m_spread);
+  if(genomeSize != (int)m_initialSpread.size()) return false;
+
+  double sum = 0;
+  int n = 0;
+  for(int g=0; g<genomeSize; g++) {
+    if(m_initialSpread[g] > 0) {
+      sum += m_spread[g]/m_initialSpread[g];
+      n++;
+    }
+  }
+  if(!n) return false;
+
+  m_diversity = sum/n;
+  return m_diversity < m_minDiversity;
+}
+
+/**
+ * @return Average standard deviation of the genes relative to the initial population.
+ */
+double DiversityTermination::getDiversity()
+{
+  return m_diversity;
+}
+
+/**
+ * The standard deviations are computed in two passes over the genomes, for numerical stability.
+ *
+ * @param population Population of models.
+ * @param spread Returns the standard deviation of each gene.
+ * @return The size of the genomes, or 0 if the models do not expose a genome.
+ */
+int DiversityTermination::computeSpread(IPopulation *population, std::vector<double> &spread)
+{
+  int n = population->size();
+  if(!n) return 0;
+  int genomeSize = population->getIndividual(0)->getGenomeSize();
+  if(genomeSize <= 0) {
+    spread.clear();
+    return 0;
+  }
+
+  m_sum.assign(genomeSize, 0);
+  for(int i=0; i<n; i++) {
+    const double *genome = population->getIndividual(i)->getGenome();
+    for(int g=0; g<genomeSize; g++) {
+      m_sum[g] += genome[g];
+    }
+  }
+  spread.assign(genomeSize, 0);
+  for(int i=0; i<n; i++) {
+    const double *genome = population->getIndividual(i)->getGenome();
+    for(int g=0; g<genomeSize; g++) {
+      double delta = genome[g] - m_sum[g]/n;
+      spread[g] += delta*delta;
+    }
+  }
+  for(int g=0; g<genomeSize; g++) {
+    spread[g] = std::sqrt(spread[g]/n);
+  }
+  return genomeSize;
+}
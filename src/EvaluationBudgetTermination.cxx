@@ -0,0 +1,37 @@
+#include "EvaluationBudgetTermination.h"
+#include "IPopulation.h"
+
+/**
+ * @param maxEvaluations Maximum number of evaluations of the figure of merit.
+ */
+EvaluationBudgetTermination::EvaluationBudgetTermination(long maxEvaluations) :
+  ITerminationPolicy()
+{
+  m_maxEvaluations = maxEvaluations;
+  m_start = 0;
+}
+
+EvaluationBudgetTermination::~EvaluationBudgetTermination()
+{
+}
+
+/**
+ * @param population Population being optimized, initialized and scored.
+ * @param generation Number of the generation the optimization starts from, 0 unless resuming.
+ */
+void EvaluationBudgetTermination::reset(IPopulation *population, int generation)
+{
+  m_start = population->getCacheMisses();
+}
+
+/**
+ * The budget can be exceeded by the evaluations of the last generation.
+ *
+ * @param population Population being optimized.
+ * @param generation Number of the last generation.
+ * @return `true` if the evaluation budget is spent.
+ */
+bool EvaluationBudgetTermination::shouldStop(IPopulation *population, int generation)
+{
+  return population->getCacheMisses() - m_start >= m_maxEvaluations;
+}
@@ -0,0 +1,222 @@
+#include "FitnessCache.h"
+
+#include <cstring>
+
+FitnessCache::FitnessCache()
+{
+  m_capacity = 0;
+  m_genomeSize = 0;
+  m_size = 0;
+  m_head = -1;
+  m_tail = -1;
+}
+
+FitnessCache::~FitnessCache()
+{
+}
+
+/**
+ * Existing entries are removed. A capacity of 0 disables the cache.
+ *
+ * @param capacity Maximum number of entries.
+ */
+void FitnessCache::setCapacity(int capacity)
+{
+  m_capacity = capacity > 0 ? capacity : 0;
+  allocate();
+}
+
+/**
+ * @return Maximum number of entries.
+ */
+int FitnessCache::getCapacity() const
+{
+  return m_capacity;
+}
+
+/**
+ * @return Number of entries.
+ */
+int FitnessCache::size() const
+{
+  return m_size;
+}
+
+void FitnessCache::clear()
+{
+  m_size = 0;
+  m_head = -1;
+  m_tail = -1;
+  for(unsigned int i=0; i<m_table.size(); i++) m_table[i] = -1;
+}
+
+/**
+ * On success, the entry becomes the most recently used one.
+ *
+ * @param genome Array of genomeSize values.
+ * @param genomeSize Number of values in the genome.
+ * @param score Returns the score of the genome, if found.
+ * @return true if the genome was found.
+ */
+bool FitnessCache::find(const double *genome, int genomeSize, double &score)
+{
+  if(!m_capacity || genomeSize != m_genomeSize || !m_size) return false;
+
+  int entry = m_table[lookup(genome, hash(genome))];
+  if(entry < 0) return false;
+
+  touch(entry);
+  score = m_scores[entry];
+  return true;
+}
+
+/**
+ * If the genome is already in the cache, its score is updated. Otherwise, if the cache is full, 
+ * the least recently used entry is replaced. Changing the genome size clears the cache.
+ *
+ * @param genome Array of genomeSize values.
+ * @param genomeSize Number of values in the genome.
+ * @param score Score of the genome.
+ */
+void FitnessCache::insert(const double *genome, int genomeSize, double score)
+{
+  if(!m_capacity || genomeSize <= 0) return;
+
+  if(genomeSize != m_genomeSize) {
+    m_genomeSize = genomeSize;
+    allocate();
+  }
+
+  uint64_t h = hash(genome);
+  int slot = lookup(genome, h);
+  int entry = m_table[slot];
+  if(entry < 0) {
+    if(m_size < m_capacity) {
+      entry = m_size++;
+    }else{
+      entry = m_tail;
+      unlink(entry);
+      erase(entry);
+      slot = lookup(genome, h);
+    }
+    std::memcpy(&m_genomes[entry*m_genomeSize], genome, m_genomeSize*sizeof(double));
+    m_hashes[entry] = h;
+    m_slot[entry] = slot;
+    m_table[slot] = entry;
+  }else{
+    unlink(entry);
+  }
+
+  m_scores[entry] = score;
+  m_prev[entry] = -1;
+  m_next[entry] = m_head;
+  if(m_head >= 0) m_prev[m_head] = entry;
+  m_head = entry;
+  if(m_tail < 0) m_tail = entry;
+}
+
+/**
+ * FNV-1a hash of the bit patterns of the genome values.
+ *
+ * @param genome Array of values.
+ * @return Hash of the genome.
+ */
+uint64_t FitnessCache::hash(const double *genome) const
+{
+  uint64_t h = 14695981039346656037ULL;
+  for(int i=0; i<m_genomeSize; i++) {
+    uint64_t bits;
+    std::memcpy(&bits, &genome[i], sizeof(bits));
+    for(int b=0; b<8; b++) {
+      h ^= (bits >> (8*b)) & 0xff;
+      h *= 1099511628211ULL;
+    }
+  }
+  return h;
+}
+
+/**
+ * @param genome Array of values.
+ * @param h Hash of the genome.
+ * @return Position in the hash table.
+ */
+int FitnessCache::lookup(const double *genome, uint64_t h) const
+{
+  int mask = m_table.size() - 1;
+  int slot = h & mask;
+  while(true) {
+    int entry = m_table[slot];
+    if(entry < 0) return slot;
+    if(m_hashes[entry] == h && 
+       std::memcmp(&m_genomes[entry*m_genomeSize], genome, m_genomeSize*sizeof(double)) == 0) {
+      return slot;
+    }
+    slot = (slot+1) & mask;
+  }
+}
+
+void FitnessCache::allocate()
+{
+  int tableSize = 1;
+  while(tableSize < 2*m_capacity) tableSize *= 2;
+
+  m_genomes.assign(m_capacity*m_genomeSize, 0);
+  m_scores.assign(m_capacity, 0);
+  m_hashes.assign(m_capacity, 0);
+  m_prev.assign(m_capacity, -1);
+  m_next.assign(m_capacity, -1);
+  m_slot.assign(m_capacity, -1);
+  m_table.assign(tableSize, -1);
+  clear();
+}
+
+/**
+ * @param entry Entry to be moved to the most recently used position.
+ */
+void FitnessCache::touch(int entry)
+{
+  if(entry == m_head) return;
+  unlink(entry);
+  m_prev[entry] = -1;
+  m_next[entry] = m_head;
+  if(m_head >= 0) m_prev[m_head] = entry;
+  m_head = entry;
+  if(m_tail < 0) m_tail = entry;
+}
+
+/**
+ * @param entry Entry to be removed from the recency list.
+ */
+void FitnessCache::unlink(int entry)
+{
+  if(m_prev[entry] >= 0) m_next[m_prev[entry]] = m_next[entry];
+  else m_head = m_next[entry];
+  if(m_next[entry] >= 0) m_prev[m_next[entry]] = m_prev[entry];
+  else m_tail = m_prev[entry];
+}
+
+/**
+ * Uses backward-shift deletion, such that no tombstone is left in the table.
+ *
+ * @param entry Entry to be removed from the hash table.
+ */
+void FitnessCache::erase(int entry)
+{
+  int mask = m_table.size() - 1;
+  int hole = m_slot[entry];
+  m_table[hole] = -1;
+  int slot = (hole+1) & mask;
+  while(m_table[slot] >= 0) {
+    int other = m_table[slot];
+    int home = m_hashes[other] & mask;
+    // Move the entry to the hole if its home position is not in ]hole, slot] (cyclically).
+    bool between = hole <= slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+    if(!between) {
+      m_table[hole] = other;
+      m_slot[other] = hole;
+      m_table[slot] = -1;
+      hole = slot;
+    }
+    slot = (slot+1) & mask;
+  }
+}
@@ -0,0 +1,24 @@
+#include "GenerationStats.h"
+
+GenerationStats::GenerationStats()
+{
+  clear();
+}
+
+/**
+ * The random draws and heap allocations are set to -1 until they are counted.
+ */
+void GenerationStats::clear()
+{
+  generation = 0;
+  totalTime = 0;
+  scoreTime = 0;
+  sortTime = 0;
+  selectionTime = 0;
+  crossOverTime = 0;
+  mutationTime = 0;
+  nEvaluations = 0;
+  cacheHits = 0;
+  randomDraws = -1;
+  allocations = -1;
+}
@@ -0,0 +1,174 @@
+#include "GenerationTrace.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+
+const uint32_t GenerationTrace::kVersion;
+
+namespace {
+
+  /** Magic string identifying a trace file. */
+  const char kMagic[8] = {'G', 'A', 'T', 'R', 'A', 'C', 'E', 0};
+
+  /** Writes a column of values. */
+  template<class T> void writeColumn(std::ostream &out, const std::vector<T> &values)
+  {
+    out.write((const char*)values.data(), values.size()*sizeof(T));
+  }
+
+  /** Reads a column of n values, appending them. Returns false if the file ends before. */
+  template<class T> bool readColumn(std::istream &in, std::vector<T> &values, uint32_t n)
+  {
+    size_t offset = values.size();
+    values.resize(offset + n);
+    in.read((char*)(values.data() + offset), n*sizeof(T));
+    return (bool)in;
+  }
+
+}
+
+GenerationTrace::GenerationTrace()
+{
+}
+
+/**
+ * @param npar Number of parameters of the best fitted individual stored in each row.
+ */
+void GenerationTrace::setNPar(int npar)
+{
+  bestParameters.resize(npar > 0 ? npar : 0);
+  clear();
+}
+
+/**
+ * @return Number of parameters per row.
+ */
+int GenerationTrace::getNPar() const
+{
+  return bestParameters.size();
+}
+
+/**
+ * @return Number of rows.
+ */
+int GenerationTrace::size() const
+{
+  return generations.size();
+}
+
+/**
+ * @param generation Generation number.
+ * @param best Score of the best fitted individual.
+ * @param mean Mean of the scores.
+ * @param rms RMS of the scores.
+ * @param parameters Array of getNPar() parameters of the best fitted individual.
+ */
+void GenerationTrace::append(int generation, double best, double mean, double rms, const double *parameters)
+{
+  generations.push_back(generation);
+  bestScores.push_back(best);
+  scoreMeans.push_back(mean);
+  scoreRMS.push_back(rms);
+  for(unsigned int p=0; p<bestParameters.size(); p++) {
+    bestParameters[p].push_back(parameters[p]);
+  }
+}
+
+void GenerationTrace::clear()
+{
+  generations.clear();
+  bestScores.clear();
+  scoreMeans.clear();
+  scoreRMS.clear();
+  for(unsigned int p=0; p<bestParameters.size(); p++) {
+    bestParameters[p].clear();
+  }
+}
+
+/**
+ * Any previous rows are removed. An incomplete last block, e.g. from a run that is still going on
+ * or that was interrupted, is ignored.
+ * Throws an exception if the file cannot be opened or is not a trace file.
+ *
+ * @param path Path of the trace file.
+ */
+void GenerationTrace::read(const std::string &path)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if(!in) {
+    std::ostringstream ostr;
+    ostr << "Failed to open trace " << path;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  char magic[sizeof(kMagic)];
+  uint32_t version = 0;
+  uint32_t npar = 0;
+  in.read(magic, sizeof(magic));
+  in.read((char*)&version, sizeof(version));
+  in.read((char*)&npar, sizeof(npar));
+  if(!in || memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    std::ostringstream ostr;
+    ostr << "File " << path << " is not a trace";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  if(version != kVersion) {
+    std::ostringstream ostr;
+    ostr << "Trace " << path << " has version " << version << ", expected " << kVersion;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  setNPar(npar);
+  uint32_t n;
+  while(in.read((char*)&n, sizeof(n))) {
+    int rows = size();
+    bool complete = readColumn(in, generations, n) && readColumn(in, bestScores, n) &&
+      readColumn(in, scoreMeans, n) && readColumn(in, scoreRMS, n);
+    for(unsigned int p=0; complete && p<npar; p++) {
+      complete = readColumn(in, bestParameters[p], n);
+    }
+    if(!complete) {
+      generations.resize(rows);
+      bestScores.resize(rows);
+      scoreMeans.resize(rows);
+      scoreRMS.resize(rows);
+      for(unsigned int p=0; p<npar; p++) {
+	bestParameters[p].resize(rows);
+      }
+      break;
+    }
+  }
+}
+
+/**
+ * @param out Stream receiving the header.
+ */
+void GenerationTrace::writeHeader(std::ostream &out) const
+{
+  uint32_t version = kVersion;
+  uint32_t npar = getNPar();
+  out.write(kMagic, sizeof(kMagic));
+  out.write((const char*)&version, sizeof(version));
+  out.write((const char*)&npar, sizeof(npar));
+}
+
+/**
+ * Nothing is written if there are no rows.
+ *
+ * @param out Stream receiving the block.
+ */
+void GenerationTrace::writeBlock(std::ostream &out) const
+{
+  uint32_t n = size();
+  if(n == 0) return;
+  out.write((const char*)&n, sizeof(n));
+  writeColumn(out, generations);
+  writeColumn(out, bestScores);
+  writeColumn(out, scoreMeans);
+  writeColumn(out, scoreRMS);
+  for(unsigned int p=0; p<bestParameters.size(); p++) {
+    writeColumn(out, bestParameters[p]);
+  }
+}
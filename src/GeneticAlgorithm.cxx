@@ -2,11 +2,28 @@
 #include "IModel.h"
 #include "IFigureOfMerit.h"
 #include "IPopulation.h"
+#include "StatsLogger.h"
+#include "ITerminationPolicy.h"
+#include "CheckpointWriter.h"
+#include "TraceWriter.h"
+
+#include <stdexcept>
+#include <sstream>
+
+#include <chrono>
 
 GeneticAlgorithm::GeneticAlgorithm()
 {
   m_generationsMax = 10000;
   m_populationSize = 100;
+  m_nOffspring = 0;
+  m_population = 0;
+  m_terminationPolicy = 0;
+  m_instrumented = false;
+  m_statsLogger = 0;
+  m_traceWriter = 0;
+  m_checkpointWriter = 0;
+  m_checkpointInterval = 0;
 }
 
 GeneticAlgorithm::~GeneticAlgorithm()
@@ -36,11 +53,51 @@ IModel *GeneticAlgorithm::optimize(IPopulation *population)
  */
 void GeneticAlgorithm::initialize(IPopulation *population) {
 
+  population->setInstrumentation(m_instrumented);
   population->initialize(m_populationSize);
   population->score();
   
   m_currentGeneration = 0;
   m_population = population;
+
+  if(m_terminationPolicy) m_terminationPolicy->reset(population, m_currentGeneration);
+  recordTrace();
+}
+
+/**
+ * @param population Population of models to optimize.
+ * @param checkpoint State from which the optimization is resumed.
+ * @return Best fitted model after optimization.
+ */
+IModel *GeneticAlgorithm::optimize(IPopulation *population, const Checkpoint &checkpoint)
+{
+
+  initialize(population, checkpoint);
+
+  while(nextGeneration());
+  
+  return population->getBestFitted();
+}
+
+/**
+ * The population is initialized with the size of the checkpoint, then its state is restored
+ * (see IPopulation::restoreState()), and the generation counter continues from the checkpoint.
+ * The population should be configured as for the run that produced the checkpoint.
+ *
+ * @param population Population of models to optimize.
+ * @param checkpoint State from which the optimization is resumed.
+ */
+void GeneticAlgorithm::initialize(IPopulation *population, const Checkpoint &checkpoint) {
+
+  population->setInstrumentation(m_instrumented);
+  population->initialize(checkpoint.size);
+  population->restoreState(checkpoint);
+
+  m_currentGeneration = checkpoint.generation;
+  m_population = population;
+
+  if(m_terminationPolicy) m_terminationPolicy->reset(population, m_currentGeneration);
+  recordTrace();
 }
 
 /**
@@ -60,11 +117,40 @@ bool GeneticAlgorithm::nextGeneration() {
     return false;
   }
 
+  if(m_terminationPolicy && m_terminationPolicy->shouldStop(m_population, m_currentGeneration)) {
+    return false;
+  }
+
   m_currentGeneration++;
 
-  m_population->crossOver();
-  m_population->mutate();
-  m_population->score();
+  std::chrono::steady_clock::time_point start;
+  if(m_instrumented) {
+    m_population->resetStats();
+    start = std::chrono::steady_clock::now();
+  }
+
+  if(m_nOffspring > 0) {
+    int nOffspring = m_nOffspring < m_population->size() ? m_nOffspring : m_population->size()-1;
+    m_population->breedSteadyState(nOffspring);
+  }else{
+    m_population->crossOver();
+    m_population->mutate();
+    m_population->score();
+  }
+
+  if(m_instrumented) {
+    m_stats = m_population->getStats();
+    m_stats.generation = m_currentGeneration;
+    m_stats.totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(m_statsLogger) m_statsLogger->write(m_stats);
+  }
+
+  recordTrace();
+
+  if(m_checkpointWriter && m_currentGeneration % m_checkpointInterval == 0) {
+    saveCheckpoint(m_checkpoint);
+    m_checkpointWriter->submit(m_checkpoint);
+  }
 
   return true;
 }
@@ -93,3 +179,107 @@ void GeneticAlgorithm::setPopulationSize(int populationSize)
 {
   m_populationSize = populationSize;
 }
+
+/**
+ * In steady-state mode, each iteration counts as a generation, such that the maximum number of generations
+ * (see setNGenerationsMax()) should be scaled accordingly.
+ *
+ * @param nOffspring Number of offspring replacing the least fitted individuals at each iteration,
+ * or 0 to replace whole generations.
+ */
+void GeneticAlgorithm::setSteadyState(int nOffspring)
+{
+  m_nOffspring = nOffspring > 0 ? nOffspring : 0;
+}
+
+/**
+ * The policy is reset at initialization, and consulted before each generation.
+ *
+ * @param policy Policy deciding whether to stop the optimization early, or 0 to only stop on acceptance or
+ * after the maximum number of generations. The policy is not owned by the algorithm.
+ */
+void GeneticAlgorithm::setTerminationPolicy(ITerminationPolicy *policy)
+{
+  m_terminationPolicy = policy;
+}
+
+/**
+ * When disabled, the stages are not timed and the statistics of the last generation are not updated.
+ * The setting is passed to the population at initialization, or immediately if it is already initialized.
+ *
+ * @param enable Whether the statistics of each generation should be recorded.
+ */
+void GeneticAlgorithm::setInstrumentation(bool enable)
+{
+  m_instrumented = enable;
+  if(m_population) m_population->setInstrumentation(enable);
+}
+
+/**
+ * @return Statistics of the last generation, if instrumentation is enabled (see setInstrumentation()).
+ */
+const GenerationStats &GeneticAlgorithm::getGenerationStats()
+{
+  return m_stats;
+}
+
+/**
+ * The statistics are only written while instrumentation is enabled (see setInstrumentation()).
+ *
+ * @param logger Logger receiving the statistics of each generation, or 0 to disable logging.
+ * The logger is not owned by the algorithm.
+ */
+void GeneticAlgorithm::setStatsLogger(StatsLogger *logger)
+{
+  m_statsLogger = logger;
+}
+
+/**
+ * A row is recorded after the initialization and after each generation. The number of parameters of the
+ * writer should match the genome size of the models (see IModel::getGenomeSize()).
+ *
+ * @param writer Writer receiving the progress of each generation, or 0 to disable the trace.
+ * The writer is not owned by the algorithm.
+ */
+void GeneticAlgorithm::setTraceWriter(TraceWriter *writer)
+{
+  m_traceWriter = writer;
+}
+
+/**
+ * The checkpoint is taken at the end of each generation whose number is a multiple of the interval,
+ * and handed over to the writer, which writes it in the background (see CheckpointWriter).
+ * The optimization loop is therefore only delayed by a copy of the genomes and scores.
+ *
+ * @param writer Writer receiving the checkpoints, or 0 to disable checkpoints. The writer is not
+ * owned by the algorithm.
+ * @param interval Number of generations between checkpoints.
+ */
+void GeneticAlgorithm::setCheckpointWriter(CheckpointWriter *writer, int interval)
+{
+  m_checkpointWriter = interval > 0 ? writer : 0;
+  m_checkpointInterval = interval;
+}
+
+/**
+ * @param checkpoint Checkpoint to be filled with the state of the population and the generation counter.
+ */
+void GeneticAlgorithm::saveCheckpoint(Checkpoint &checkpoint)
+{
+  m_population->saveState(checkpoint);
+  checkpoint.generation = m_currentGeneration;
+}
+
+void GeneticAlgorithm::recordTrace()
+{
+  if(!m_traceWriter) return;
+
+  IModel *best = m_population->getBestFitted();
+  if(best->getGenomeSize() != m_traceWriter->getNPar()) {
+    std::ostringstream ostr;
+    ostr << "Genome size (" << best->getGenomeSize() << ") differs from the trace's (" << m_traceWriter->getNPar() << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_traceWriter->record(m_currentGeneration, best->getScore(), m_population->getScoreMean(), m_population->getScoreRMS(),
+			best->getGenome());
+}
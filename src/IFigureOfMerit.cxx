@@ -11,6 +11,37 @@ IFigureOfMerit::~IFigureOfMerit()
 {
 }
 
+/**
+ * The default implementation calls evaluate() for each model.
+ *
+ * Derived classes can reimplement this method to amortize the cost of the evaluation over several models,
+ * e.g. by looping over the data in the outer loop and over the models in the inner loop. 
+ * If the figure of merit is thread-safe, this method may be called concurrently on disjoint sets of models.
+ *
+ * @param models Array of models to be evaluated.
+ * @param n Number of models.
+ * @param scores Array of n scores to be filled.
+ */
+void IFigureOfMerit::evaluateBatch(IModel *const *models, int n, double *scores) const
+{
+  for(int i=0; i<n; i++) {
+    scores[i] = evaluate(models[i]);
+  }
+}
+
+/**
+ * The default is `false`, such that populations compute the scores serially.
+ *
+ * Derived classes should return `true` only if evaluate() can be called concurrently
+ * for different models, i.e. it does not modify shared state.
+ *
+ * @return true if evaluate() is thread-safe.
+ */
+bool IFigureOfMerit::isThreadSafe() const
+{
+  return false;
+}
+
 /**
  * The default behavior is to apply a threshold on the score.
  *
@@ -67,6 +98,20 @@ bool IFigureOfMerit::isBetterThan(IModel *modelToTest, IModel *referenceModel) c
   return isBetterThan(modelToTest->getScore(), referenceModel->getScore());
 }
 
+/**
+ * Populations use this to decide whether the ranking can be performed on cached scores
+ * (see IPopulation::sort()) rather than by comparing the models themselves.
+ *
+ * The default is `true`. Derived classes that reimplement isBetterThan(IModel*, IModel*)
+ * with a decision that is not based solely on the scores should return `false`.
+ *
+ * @return true if comparing two models is equivalent to comparing their scores.
+ */
+bool IFigureOfMerit::ranksOnScore() const
+{
+  return true;
+}
+
 /**
  * @param threshold score threshold to accept a model as a final answer.
  */
@@ -1,9 +1,12 @@
 #include "IModel.h"
 
+#include <stdexcept>
+
 IModel::IModel()
 {
   
   m_score = 0;
+  m_dirty = true;
 }
 
 IModel::~IModel()
@@ -25,5 +28,50 @@ void IModel::setScore(double score)
 {
   
   m_score = score;
+  m_dirty = false;
+}
+
+/**
+ * @return true if the score needs to be recomputed.
+ */
+bool IModel::isDirty() const
+{
+  return m_dirty;
+}
+
+void IModel::setDirty()
+{
+  m_dirty = true;
+}
+
+/**
+ * The default implementation returns 0: the model does not expose a genome.
+ *
+ * @return Number of values returned by getGenome().
+ */
+int IModel::getGenomeSize() const
+{
+  return 0;
+}
+
+/**
+ * The default implementation returns 0: the model does not expose a genome.
+ *
+ * @return Array of getGenomeSize() values describing this model.
+ */
+const double *IModel::getGenome() const
+{
+  return 0;
 }
   
+
+/**
+ * The default implementation throws an exception: the model does not expose a genome.
+ * Derived classes exposing a genome should reimplement this method, and mark the score as out of date.
+ *
+ * @param genome Array of getGenomeSize() values describing this model.
+ */
+void IModel::setGenome(const double *)
+{
+  throw std::runtime_error("Model does not expose a genome");
+}
@@ -0,0 +1,71 @@
+#include "IParentSelector.h"
+
+#include <cmath>
+
+IParentSelector::IParentSelector()
+{
+  m_n = 0;
+}
+
+IParentSelector::~IParentSelector()
+{
+}
+
+/**
+ * The default implementation only stores the number of individuals eligible as parents.
+ * Derived classes overriding this method should call it.
+ *
+ * @param n Number of individuals eligible as parents.
+ * @param scores Array of the n scores of these individuals, from the best to the least fitted.
+ */
+void IParentSelector::prepare(int n, const double *scores)
+{
+  m_n = n;
+}
+
+/**
+ * The fitness of an individual is the distance of its score to the score of the least fitted individual,
+ * such that it does not depend on whether higher or lower scores are better. The least fitted individual
+ * thus has a null weight. If all weights are null, e.g. when all scores are equal, all individuals get the same weight.
+ * Scores that are not finite get a null weight.
+ *
+ * @param n Number of individuals.
+ * @param scores Array of the n scores, from the best to the least fitted.
+ * @param weights Returns the n weights.
+ * @return The sum of the weights.
+ */
+double IParentSelector::computeFitness(int n, const double *scores, std::vector<double> &weights)
+{
+  weights.resize(n);
+  if(n <= 0) return 0;
+
+  double worst = scores[n-1];
+  double total = 0;
+  for(int i=0; i<n; i++) {
+    double w = std::fabs(scores[i] - worst);
+    if(!std::isfinite(w)) w = 0;
+    weights[i] = w;
+    total += w;
+  }
+
+  if(total <= 0 || !std::isfinite(total)) {
+    for(int i=0; i<n; i++) {
+      weights[i] = 1;
+    }
+    total = n;
+  }
+  return total;
+}
+
+/**
+ * @param exclude Individual that should not be drawn.
+ * @param n Number of individuals, should be at least 2.
+ * @param random Random number generator.
+ * @return An individual in [0, n[ different from exclude.
+ */
+int IParentSelector::drawOther(int exclude, int n, RandomStream &random)
+{
+  int p = random.Integer(n-1);
+  if(p >= exclude) p++;
+  return p;
+}
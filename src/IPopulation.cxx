@@ -2,75 +2,204 @@
 
 #include "IModel.h"
 #include "IFigureOfMerit.h"
+#include "ThreadPool.h"
+#include "LinearRankSelector.h"
+#include "InstrumentationCounters.h"
+#include "StageTimer.h"
+#include "Checkpoint.h"
+#include "ModelPool.h"
 
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+  /**
+   * @brief Orders sort keys using the cached scores.
+   *
+   * Ties are broken using the position before ranking, such that the ranking is stable.
+   */
+  struct ScoreOrder {
+    const IFigureOfMerit *fom;
+    template<class Key> bool operator()(const Key &a, const Key &b) const {
+      if(fom->isBetterThan(a.score, b.score)) return true;
+      if(fom->isBetterThan(b.score, a.score)) return false;
+      return a.index < b.index;
+    }
+  };
+
+  /**
+   * @brief Orders sort keys by comparing the models themselves.
+   *
+   * Used for figures of merit whose decision is not based solely on the scores.
+   */
+  struct ModelOrder {
+    const IFigureOfMerit *fom;
+    template<class Key> bool operator()(const Key &a, const Key &b) const {
+      if(fom->isBetterThan(a.model, b.model)) return true;
+      if(fom->isBetterThan(b.model, a.model)) return false;
+      return a.index < b.index;
+    }
+    bool operator()(IModel *a, IModel *b) const {
+      return fom->isBetterThan(a, b);
+    }
+  };
+
+  /**
+   * @brief Orders models using their scores.
+   */
+  struct ModelScoreOrder {
+    const IFigureOfMerit *fom;
+    bool operator()(IModel *a, IModel *b) const {
+      return fom->isBetterThan(a->getScore(), b->getScore());
+    }
+  };
+}
 
 IPopulation::IPopulation()
 {
-  m_sorted = false;
+  m_nRanked = 0;
+  m_selectionWindow = 0;
   m_fom = 0;
-  m_random = new TRandom3(1234);
+  m_seed = 1234;
+  m_generation = 0;
   m_mutateRate = 0.01;
   m_scoreMean = 0;
   m_scoreRMS = 0;
+  m_scoreSum = 0;
+  m_scoreSum2 = 0;
+  m_rankedScoresValid = false;
+  m_threadPool = 0;
+  m_chunkSize = 0;
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
+  m_defaultParentSelector = new LinearRankSelector();
+  m_parentSelector = m_defaultParentSelector;
+  m_defaultModelPool = new ModelPool();
+  m_modelPool = m_defaultModelPool;
+  m_modelOwner = 0;
+  m_instrumented = false;
+  resetStats();
 }
 
 IPopulation::~IPopulation()
 {
-  delete m_random;
+  delete m_threadPool;
+  delete m_defaultParentSelector;
+  delete m_defaultModelPool;
 }
 
 /**
+ * Buffers used to breed the next generations are allocated here once, such that
+ * subsequent generations do not allocate memory.
+ *
  * @param n Desired size of the population.
  */
 void IPopulation::initialize(int n)
 {
+  m_generation = 0;
   doInitialize(n);
-  m_sorted = false;
+  for(int i=0; i<size(); i++) {
+    m_individuals[i]->setDirty();
+  }
+  m_cache.clear();
+  m_parents.resize(2*size());
+  m_copies.resize(size());
+  m_parentScores.resize(size());
+  m_parentDirty.resize(size());
+  m_scores.resize(size());
+  m_toScore.reserve(size());
+  m_rankKeys.reserve(size());
+  m_rankBuffer.reserve(size());
+  m_nRanked = 0;
 }
 
+/**
+ * Parents are passed to doCrossOver() as a flat list of indices in the ranked population:
+ * the parents of the i-th offspring are at positions 2i and 2i+1 of the list.
+ * The best fitted individual is preserved intact as the first offspring: its second parent index is -1.
+ *
+ * doCrossOver() is called for chunks of offspring, concurrently if the population has several threads and
+ * the breeding is thread-safe (see isBreedingThreadSafe()). Since it uses one random stream per offspring,
+ * the result does not depend on the number of threads. doReplaceParents() is then called once.
+ *
+ * doCrossOver() may report offspring that are identical to one of their parents in m_copies:
+ * these inherit the score of their parent. The scores of all other offspring are marked out of date.
+ */
 void IPopulation::crossOver()
 {
 
-  sort();
+  if(!size()) return;
+
+  sort(selectionSize());
+  m_generation++;
+
+  {
+    StageTimer timer(m_instrumented ? &m_stats.selectionTime : 0);
+    for(int i=0; i<size(); i++) {
+      m_parentScores[i] = m_individuals[i]->getScore();
+      m_parentDirty[i] = m_individuals[i]->isDirty();
+      m_copies[i] = -1;
+    }
+
+    m_parents.resize(2*size());
+    m_parents[0] = 0;
+    m_parents[1] = -1;
+    if(size() > 1) selectParents(size()-1, &m_parents[2]);
+    m_copies[0] = 0;
+  }
+
+  StageTimer timer(m_instrumented ? &m_stats.crossOverTime : 0);
+  if(m_threadPool && isBreedingThreadSafe()) {
+    m_threadPool->parallelFor(size(), m_chunkSize, [this](int begin, int end) {
+	doCrossOver(m_parents, begin, end);
+      });
+  }else{
+    doCrossOver(m_parents, 0, size());
+  }
+  doReplaceParents(0, size());
 
-  m_parents.resize(size());
   for(int i=0; i<size(); i++) {
-    if(i==0) {
-      m_parents[i].resize(1);
-      m_parents[i][0] = m_individuals[0];
+    int parent = m_copies[i];
+    if(parent >= 0 && !m_parentDirty[parent]) {
+      m_individuals[i]->setScore(m_parentScores[parent]);
     }else{
-      int p1, p2;
-      selectParents(p1, p2);
-      m_parents[i].resize(2);
-      m_parents[i][0] = m_individuals[p1];
-      m_parents[i][1] = m_individuals[p2];
+      m_individuals[i]->setDirty();
     }
   }
-  doCrossOver(m_parents);
-  m_sorted = false;
+  m_nRanked = 0;
 }
 
+/**
+ * Each individual uses its own random stream to decide whether it is mutated,
+ * and the same stream is passed to doMutate(). Chunks of individuals are mutated concurrently
+ * if the population has several threads and the breeding is thread-safe (see isBreedingThreadSafe()).
+ */
 void IPopulation::mutate()
 {
-  for(int i=0; i<size(); i++) {
-    double f = m_random->Uniform(0,1);
-    if(f < m_mutateRate) {
-      doMutate(m_individuals[i]);
-    }
+  StageTimer timer(m_instrumented ? &m_stats.mutationTime : 0);
+  if(m_threadPool && isBreedingThreadSafe()) {
+    m_threadPool->parallelFor(size(), m_chunkSize, [this](int begin, int end) {
+	mutateRange(begin, end);
+      });
+  }else{
+    mutateRange(0, size());
   }
-  m_sorted = false;
+  m_nRanked = 0;
 }
 
 /**
+ * The seed takes effect for all subsequent random streams. It is usually set before the initialization.
+ *
  * @param seed Random number generator seed.
  */
 void IPopulation::setRandomSeed(int seed)
 {
   
-  m_random->SetSeed(seed);
+  m_seed = seed;
 }
 
 /**
@@ -88,6 +217,37 @@ void IPopulation::setMutateRate(double rate)
 }
 
 /**
+ * @param nThreads Number of threads, including the calling thread. Use 1 to compute the scores serially.
+ *
+ * Multithreaded scoring is only used if the figure of merit is thread-safe
+ * (see IFigureOfMerit::isThreadSafe()). Otherwise, scores are computed serially.
+ * Likewise, cross-over and mutation are only multithreaded if isBreedingThreadSafe() returns true.
+ */
+void IPopulation::setNThreads(int nThreads)
+{
+  if(nThreads < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of threads (" << nThreads << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  delete m_threadPool;
+  m_threadPool = 0;
+  if(nThreads > 1) m_threadPool = new ThreadPool(nThreads);
+}
+
+/**
+ * @param chunkSize Number of consecutive individuals bred or scored by a thread at once.
+ * If 0 or less, the population is split into about four chunks per thread.
+ */
+void IPopulation::setChunkSize(int chunkSize)
+{
+  m_chunkSize = chunkSize > 0 ? chunkSize : 0;
+}
+
+/**
+ * Only the individuals whose score is out of date, and whose genome is not found in the fitness cache,
+ * are evaluated (see scoreRange()).
+ *
  * This function also calculates the mean and RMS for the scores of this population.
  */
 void IPopulation::score() {
@@ -96,22 +256,409 @@ void IPopulation::score() {
   
   if(!size()) return;
   
-  m_scoreMean = 0;
-  m_scoreRMS = 0;
+  if(scoreRange(0, size()) > 0) m_nRanked = 0;
 
+  m_scoreSum = 0;
+  m_scoreSum2 = 0;
   for(int i=0; i<size(); i++) {
-    double score = m_fom->evaluate(m_individuals[i]);
-    m_individuals[i]->setScore(score);
-    m_scoreMean += score;
-    m_scoreRMS += score*score;
-  }
-  m_scoreMean /= size();
-  m_scoreRMS /= size();
-  m_scoreRMS = m_scoreRMS - m_scoreMean*m_scoreMean;
-  if(m_scoreRMS<0) m_scoreRMS = 0;
-  m_scoreRMS = sqrt(m_scoreRMS);
+    double score = m_individuals[i]->getScore();
+    m_scoreSum += score;
+    m_scoreSum2 += score*score;
+  }
+  updateScoreMoments(size());
+
+  sort(selectionSize());
+}
+
+/**
+ * Each step replaces the nOffspring least fitted individuals with offspring of parents selected among
+ * the best fitted individuals, as for a generation (see crossOver() and mutate()), and only these offspring
+ * are evaluated. The offspring are then merged into the ranking, which stays valid for the whole population:
+ * apart from the first step, which ranks the whole population, the ranking only moves the individuals ranked
+ * below the best offspring. The mean and RMS of the scores are updated incrementally.
+ *
+ * The best fitted individual is never replaced.
+ *
+ * @param nOffspring Number of offspring produced at this step, in [1, size()-1].
+ */
+void IPopulation::breedSteadyState(int nOffspring)
+{
+  checkFigureOfMerit();
+
+  int n = size();
+  if(n < 2) return;
+  if(nOffspring < 1 || nOffspring > n-1) {
+    std::ostringstream ostr;
+    ostr << "Number of offspring (" << nOffspring << ") is out of range [" << 1 << ", " << n-1 << "]";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  prepareSteadyState();
+  breedOffspring(n-nOffspring, n);
+  scoreRange(n-nOffspring, n);
+  insertOffspring(n-nOffspring, n);
+}
+
+/**
+ * All individuals are scored and ranked, unless this was already done by a previous steady-state step.
+ */
+void IPopulation::prepareSteadyState()
+{
+  checkFigureOfMerit();
+
+  if(m_nRanked == size() && m_rankedScoresValid) return;
+
+  score();
+  sort();
+  for(int i=0; i<size(); i++) {
+    m_parentScores[i] = m_individuals[i]->getScore();
+  }
+  m_rankedScoresValid = true;
+}
+
+/**
+ * The individuals in [begin, end) are replaced with offspring of parents selected among the individuals
+ * ranked before begin, and are mutated. Offspring identical to one of their parents inherit its score,
+ * the scores of the others are out of date. The offspring are not part of the ranking until they are
+ * scored and inserted with insertOffspring(): in the meantime, other ranges can be bred and the
+ * best fitted individuals can be accessed.
+ *
+ * The population should be prepared with prepareSteadyState(), and [begin, end) should be the last
+ * ranked individuals.
+ *
+ * @param begin Index of the first individual to be replaced, at least 1.
+ * @param end Index after the last individual to be replaced.
+ */
+void IPopulation::breedOffspring(int begin, int end)
+{
+  if(!m_rankedScoresValid || begin < 1 || begin >= end || end != m_nRanked) {
+    std::ostringstream ostr;
+    ostr << "Range [" << begin << ", " << end << "[ is not at the end of the " << m_nRanked
+	 << " ranked individuals (see IPopulation::prepareSteadyState())";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  m_generation++;
+
+  for(int i=begin; i<end; i++) {
+    m_copies[i] = -1;
+    m_scoreSum -= m_parentScores[i];
+    m_scoreSum2 -= m_parentScores[i]*m_parentScores[i];
+  }
+  m_nRanked = begin;
+  {
+    StageTimer timer(m_instrumented ? &m_stats.selectionTime : 0);
+    selectParents(end-begin, &m_parents[2*begin]);
+  }
+
+  {
+    StageTimer timer(m_instrumented ? &m_stats.crossOverTime : 0);
+    if(m_threadPool && isBreedingThreadSafe()) {
+      m_threadPool->parallelFor(end-begin, m_chunkSize, [this, begin](int first, int last) {
+	  doCrossOver(m_parents, begin+first, begin+last);
+	});
+    }else{
+      doCrossOver(m_parents, begin, end);
+    }
+    doReplaceParents(begin, end);
+
+    for(int i=begin; i<end; i++) {
+      int parent = m_copies[i];
+      if(parent >= 0) {
+	m_individuals[i]->setScore(m_parentScores[parent]);
+      }else{
+	m_individuals[i]->setDirty();
+      }
+    }
+  }
+
+  StageTimer timer(m_instrumented ? &m_stats.mutationTime : 0);
+  if(m_threadPool && isBreedingThreadSafe()) {
+    m_threadPool->parallelFor(end-begin, m_chunkSize, [this, begin](int first, int last) {
+	mutateRange(begin+first, begin+last);
+      });
+  }else{
+    mutateRange(begin, end);
+  }
+}
+
+/**
+ * The scored offspring in [begin, end) are merged into the ranking. Offspring bred later, lying between
+ * the ranked individuals and begin, are moved after end. The mean and RMS of the scores are updated for the
+ * ranked individuals.
+ *
+ * @param begin Index of the first offspring.
+ * @param end Index after the last offspring.
+ */
+void IPopulation::insertOffspring(int begin, int end)
+{
+  int nRanked = m_nRanked;
+  if(!m_rankedScoresValid || begin < nRanked || begin >= end || end > size()) {
+    std::ostringstream ostr;
+    ostr << "Range [" << begin << ", " << end << "[ does not follow the " << nRanked
+	 << " ranked individuals (see IPopulation::breedOffspring())";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  StageTimer timer(m_instrumented ? &m_stats.sortTime : 0);
+  if(begin > nRanked) {
+    std::rotate(m_individuals.begin()+nRanked, m_individuals.begin()+begin, m_individuals.begin()+end);
+  }
+  int n = nRanked + end - begin;
+
+  for(int i=nRanked; i<n; i++) {
+    double score = m_individuals[i]->getScore();
+    m_scoreSum += score;
+    m_scoreSum2 += score*score;
+  }
+  if(!std::isfinite(m_scoreSum) || !std::isfinite(m_scoreSum2)) {
+    // Non-finite scores cannot be removed from the sums: recompute them
+    m_scoreSum = 0;
+    m_scoreSum2 = 0;
+    for(int i=0; i<n; i++) {
+      double score = m_individuals[i]->getScore();
+      m_scoreSum += score;
+      m_scoreSum2 += score*score;
+    }
+  }
+  updateScoreMoments(n);
+
+  if(m_fom->ranksOnScore()) {
+    ModelScoreOrder compare = {m_fom};
+    insertRanked(nRanked, n, compare);
+  }else{
+    ModelOrder compare = {m_fom};
+    insertRanked(nRanked, n, compare);
+  }
+}
+
+/**
+ * Individuals whose score is out of date are looked up in the fitness cache. The remaining ones should be
+ * evaluated, and their scores set with setScores().
+ *
+ * @param begin Index of the first individual.
+ * @param end Index after the last individual.
+ * @param unscored Returns the individuals that need to be evaluated.
+ * @return Number of individuals whose score was out of date.
+ */
+int IPopulation::findUnscored(int begin, int end, std::vector<IModel*> &unscored)
+{
+  int nOutdated = 0;
+  unscored.clear();
+  for(int i=begin; i<end; i++) {
+    IModel *model = m_individuals[i];
+    if(!model->isDirty()) {
+      m_cacheHits++;
+      continue;
+    }
+    nOutdated++;
+    double score;
+    if(m_cache.find(model->getGenome(), model->getGenomeSize(), score)) {
+      model->setScore(score);
+      m_cacheHits++;
+      continue;
+    }
+    unscored.push_back(model);
+  }
+  m_cacheMisses += unscored.size();
+  return nOutdated;
+}
+
+/**
+ * The scores are also stored in the fitness cache.
+ *
+ * @param models Array of models, usually returned by findUnscored().
+ * @param n Number of models.
+ * @param scores Array of n scores.
+ */
+void IPopulation::setScores(IModel *const *models, int n, const double *scores)
+{
+  for(int i=0; i<n; i++) {
+    models[i]->setScore(scores[i]);
+    m_cache.insert(models[i]->getGenome(), models[i]->getGenomeSize(), scores[i]);
+  }
+}
+
+/**
+ * This is used to introduce individuals coming from another population, e.g. migrants between
+ * islands (see IslandGeneticAlgorithm). The individuals of this population must expose
+ * a genome of the same size (see IModel::getGenome()).
+ *
+ * @param n Number of individuals to be replaced.
+ * @param genomeSize Number of values per genome.
+ * @param genomes Array of n genomes, stored one after the other.
+ * @param scores Array of n scores of the given genomes, or 0 if they need to be evaluated.
+ * When the scores are given, the mean and RMS of the scores are updated for the replaced individuals,
+ * otherwise they are updated when the new individuals are scored.
+ */
+void IPopulation::replaceWorst(int n, int genomeSize, const double *genomes, const double *scores)
+{
+  if(n < 0 || n > size()) {
+    std::ostringstream ostr;
+    ostr << "Number of individuals to replace (" << n << ") is out of range [" << 0 << ", " << size() << "]";
+    throw std::runtime_error(ostr.str().c_str());
+  }
 
   sort();
+
+  for(int i=0; i<n; i++) {
+    IModel *model = m_individuals[size()-1-i];
+    if(model->getGenomeSize() != genomeSize) {
+      std::ostringstream ostr;
+      ostr << "Genome size (" << genomeSize << ") differs from the population's (" << model->getGenomeSize() << ")";
+      throw std::runtime_error(ostr.str().c_str());
+    }
+    double replaced = model->getScore();
+    m_scoreSum -= replaced;
+    m_scoreSum2 -= replaced*replaced;
+    model->setGenome(genomes + i*genomeSize);
+    if(scores) {
+      model->setScore(scores[i]);
+      m_scoreSum += scores[i];
+      m_scoreSum2 += scores[i]*scores[i];
+    }
+  }
+  m_nRanked = 0;
+  m_rankedScoresValid = false;
+
+  if(scores && n > 0) {
+    if(!std::isfinite(m_scoreSum) || !std::isfinite(m_scoreSum2)) {
+      // Non-finite scores cannot be removed from the sums: recompute them
+      m_scoreSum = 0;
+      m_scoreSum2 = 0;
+      for(int i=0; i<size(); i++) {
+	double score = m_individuals[i]->getScore();
+	m_scoreSum += score;
+	m_scoreSum2 += score*score;
+      }
+    }
+    updateScoreMoments(size());
+  }
+}
+
+/**
+ * The individuals are saved in their current order, with their genomes (see IModel::getGenome()), scores
+ * and out of date flags. The generation counter of the algorithm is left to the caller.
+ * The buffers of the checkpoint are reused, such that saving the state of a population of the same size
+ * does not allocate memory.
+ *
+ * @param checkpoint Checkpoint to be filled.
+ */
+void IPopulation::saveState(Checkpoint &checkpoint)
+{
+  int n = size();
+  int genomeSize = n > 0 ? m_individuals[0]->getGenomeSize() : 0;
+  if(n > 0 && genomeSize <= 0) {
+    throw std::runtime_error("Models do not expose a genome");
+  }
+
+  checkpoint.seed = m_seed;
+  checkpoint.populationGeneration = m_generation;
+  checkpoint.size = n;
+  checkpoint.genomeSize = genomeSize;
+  checkpoint.nRanked = m_nRanked;
+  checkpoint.rankedScoresValid = m_rankedScoresValid;
+  checkpoint.scoreSum = m_scoreSum;
+  checkpoint.scoreSum2 = m_scoreSum2;
+  checkpoint.scoreMean = m_scoreMean;
+  checkpoint.scoreRMS = m_scoreRMS;
+  checkpoint.cacheHits = m_cacheHits;
+  checkpoint.cacheMisses = m_cacheMisses;
+
+  checkpoint.genomes.resize((size_t)n*genomeSize);
+  checkpoint.scores.resize(n);
+  checkpoint.dirty.resize(n);
+  for(int i=0; i<n; i++) {
+    const double *genome = m_individuals[i]->getGenome();
+    std::copy(genome, genome + genomeSize, checkpoint.genomes.begin() + (size_t)i*genomeSize);
+    checkpoint.scores[i] = m_individuals[i]->getScore();
+    checkpoint.dirty[i] = m_individuals[i]->isDirty();
+  }
+  if(m_rankedScoresValid) {
+    checkpoint.parentScores.assign(m_parentScores.begin(), m_parentScores.begin() + n);
+  }else{
+    checkpoint.parentScores.clear();
+  }
+}
+
+/**
+ * The population should be initialized with the size of the checkpoint (see initialize()). The genomes,
+ * scores, ranking and random seed are then replaced by those of the checkpoint, such that the next
+ * generations are identical to those that followed the saved state. The fitness cache is cleared.
+ *
+ * @param checkpoint Checkpoint to be restored.
+ */
+void IPopulation::restoreState(const Checkpoint &checkpoint)
+{
+  int n = size();
+  if(checkpoint.size != n) {
+    std::ostringstream ostr;
+    ostr << "Checkpoint size (" << checkpoint.size << ") differs from the population's (" << n << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  if(n > 0 && m_individuals[0]->getGenomeSize() != checkpoint.genomeSize) {
+    std::ostringstream ostr;
+    ostr << "Genome size (" << checkpoint.genomeSize << ") differs from the population's (" << m_individuals[0]->getGenomeSize() << ")";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  for(int i=0; i<n; i++) {
+    IModel *model = m_individuals[i];
+    model->setGenome(&checkpoint.genomes[(size_t)i*checkpoint.genomeSize]);
+    if(checkpoint.dirty[i]) {
+      model->setDirty();
+    }else{
+      model->setScore(checkpoint.scores[i]);
+    }
+  }
+
+  m_seed = checkpoint.seed;
+  m_generation = checkpoint.populationGeneration;
+  m_nRanked = checkpoint.nRanked;
+  m_rankedScoresValid = checkpoint.rankedScoresValid;
+  if(m_rankedScoresValid) {
+    std::copy(checkpoint.parentScores.begin(), checkpoint.parentScores.end(), m_parentScores.begin());
+  }
+  m_scoreSum = checkpoint.scoreSum;
+  m_scoreSum2 = checkpoint.scoreSum2;
+  m_scoreMean = checkpoint.scoreMean;
+  m_scoreRMS = checkpoint.scoreRMS;
+  m_cacheHits = checkpoint.cacheHits;
+  m_cacheMisses = checkpoint.cacheMisses;
+  m_cache.clear();
+}
+
+/**
+ * When a window is set, parents are only selected among the `window` best fitted individuals,
+ * with the same rank-based probability as for the full population. Only these individuals need
+ * to be ranked at each generation, which allows the ranking to be done in linear time
+ * for the rest of the population.
+ *
+ * @param window Number of best fitted individuals eligible as parents (0 or less for the whole population).
+ */
+void IPopulation::setSelectionWindow(int window)
+{
+  m_selectionWindow = window > 0 ? window : 0;
+  m_nRanked = 0;
+}
+
+/**
+ * The selector is not owned by the population, and may be shared by several populations
+ * as long as they are not bred concurrently.
+ *
+ * @param selector Pointer to the parent selection strategy, or 0 to restore the default linear rank-based selection.
+ */
+void IPopulation::setParentSelector(IParentSelector *selector)
+{
+  m_parentSelector = selector ? selector : m_defaultParentSelector;
+}
+
+/**
+ * @return Pointer to the parent selection strategy.
+ */
+IParentSelector *IPopulation::getParentSelector()
+{
+  return m_parentSelector;
 }
 
 /**
@@ -120,6 +667,104 @@ void IPopulation::score() {
 void IPopulation::setFigureOfMerit(IFigureOfMerit *fom)
 {
   m_fom = fom;
+  invalidateScores();
+}
+
+/**
+ * The cache is disabled by default. Enabling it is useful when identical genomes are likely to
+ * reappear across generations, and is only effective for models exposing their genome
+ * (see IModel::getGenome()).
+ *
+ * @param capacity Maximum number of genomes in the cache. Use 0 to disable the cache.
+ */
+void IPopulation::setFitnessCacheSize(int capacity)
+{
+  m_cache.setCapacity(capacity);
+}
+
+/**
+ * This should be called whenever the scores computed by the figure of merit may have changed,
+ * e.g. when modifying the data used by the figure of merit. The population is ranked again, and steady-state
+ * offspring no longer inherit the previous scores of their parents (see prepareSteadyState()).
+ */
+void IPopulation::invalidateScores()
+{
+  for(int i=0; i<size(); i++) {
+    m_individuals[i]->setDirty();
+  }
+  m_cache.clear();
+  m_nRanked = 0;
+  m_rankedScoresValid = false;
+}
+
+/**
+ * @return Number of scores that were up to date or found in the fitness cache.
+ */
+long IPopulation::getCacheHits()
+{
+  return m_cacheHits;
+}
+
+/**
+ * @return Number of scores that were evaluated by the figure of merit.
+ */
+long IPopulation::getCacheMisses()
+{
+  return m_cacheMisses;
+}
+
+void IPopulation::resetCacheCounters()
+{
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
+  m_statsCacheHits = 0;
+  m_statsCacheMisses = 0;
+}
+
+/**
+ * Timing the stages only costs a test when disabled. The evaluations and cache hits are counted in any case.
+ *
+ * @param enable Whether the stages should be timed.
+ */
+void IPopulation::setInstrumentation(bool enable)
+{
+  m_instrumented = enable;
+}
+
+/**
+ * @return `true` if the stages are timed.
+ */
+bool IPopulation::isInstrumented()
+{
+  return m_instrumented;
+}
+
+/**
+ * The stage times are only measured if the population is instrumented (see setInstrumentation()).
+ * The total time and the generation number are left for the caller to fill (see GeneticAlgorithm).
+ * The random draws and heap allocations are counted for the whole process, if the counters are
+ * compiled in (see InstrumentationCounters).
+ *
+ * @return Times and counters since the last call to resetStats().
+ */
+const GenerationStats &IPopulation::getStats()
+{
+  m_stats.nEvaluations = m_cacheMisses - m_statsCacheMisses;
+  m_stats.cacheHits = m_cacheHits - m_statsCacheHits;
+  if(InstrumentationCounters::isEnabled()) {
+    m_stats.randomDraws = InstrumentationCounters::getRandomDraws() - m_statsRandomDraws;
+    m_stats.allocations = InstrumentationCounters::getAllocations() - m_statsAllocations;
+  }
+  return m_stats;
+}
+
+void IPopulation::resetStats()
+{
+  m_stats.clear();
+  m_statsCacheHits = m_cacheHits;
+  m_statsCacheMisses = m_cacheMisses;
+  m_statsRandomDraws = InstrumentationCounters::getRandomDraws();
+  m_statsAllocations = InstrumentationCounters::getAllocations();
 }
 
 /**
@@ -143,11 +788,29 @@ IModel *IPopulation::getBestFitted(int rank)
     throw std::runtime_error(ostr.str().c_str());
   }
   
-  sort();
+  sort(rank+1);
 
   return m_individuals[rank];
 }
 
+/**
+ * This gives access to all individuals in an unspecified order, e.g. to compute statistics on their genomes,
+ * without the cost of ranking the whole population.
+ *
+ * @param index Position of the model, in [0, size()[.
+ * @return Model at the given position.
+ */
+IModel *IPopulation::getIndividual(int index)
+{
+  if(index < 0 || index >= size()) {
+    std::ostringstream ostr;
+    ostr << "Index (" << index << ") is out of range [" << 0 << ", " << size() << "[";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  return m_individuals[index];
+}
+
 /**
  * @return Size of this population.
  */
@@ -172,39 +835,140 @@ double IPopulation::getScoreRMS()
   return m_scoreRMS;
 }
 
+/**
+ * Models taken from the pool or created after acquireModel() are given back to the pool, to be recycled
+ * by the next initialization. Other models are deleted.
+ */
 void IPopulation::clear()
 {  
   for(int i=0; i<size(); i++) {
-    delete m_individuals[i];
+    if(m_modelOwner) {
+      m_modelPool->release(*m_modelOwner, m_individuals[i]);
+    }else{
+      delete m_individuals[i];
+    }
   }
   m_individuals.clear();
+  m_nRanked = 0;
+}
+
+/**
+ * The models of the population are given back to the current pool first. A pool shared by several populations
+ * allows models to be recycled from one population to the next, e.g. across fits.
+ *
+ * @param pool Pool recycling the models, not owned by the population, or 0 to restore the pool owned by the population.
+ * The pool should outlive the population.
+ */
+void IPopulation::setModelPool(ModelPool *pool)
+{
+  clear();
+  m_modelPool = pool ? pool : m_defaultModelPool;
+}
+
+/**
+ * @return Pointer to the pool recycling the models.
+ */
+ModelPool *IPopulation::getModelPool()
+{
+  return m_modelPool;
 }
 
-void IPopulation::sort()
+/**
+ * The ranking is performed on the cached scores of the individuals, unless the figure of merit
+ * needs to compare the models themselves (see IFigureOfMerit::ranksOnScore()).
+ * Individuals with equivalent scores keep their relative order.
+ *
+ * @param nBest Number of best fitted individuals that need to be ranked. The remaining individuals
+ * are only guaranteed not to be better than any of these. Use 0 or less to rank the whole population.
+ */
+void IPopulation::sort(int nBest)
 {
-  if(m_sorted) return;
+  if(nBest <= 0 || nBest > size()) nBest = size();
+  if(m_nRanked >= nBest) return;
 
   checkFigureOfMerit();
+  m_rankedScoresValid = false;
+  StageTimer timer(m_instrumented ? &m_stats.sortTime : 0);
 
-  m_sorted = true;
-  
-  if(size() <= 1) return;
-  
+  if(size() <= 1) {
+    m_nRanked = size();
+    return;
+  }
+
+  if(m_fom->ranksOnScore()) {
+    ScoreOrder compare = {m_fom};
+    rank(nBest, compare);
+  }else{
+    ModelOrder compare = {m_fom};
+    rank(nBest, compare);
+  }
+}
+
+/**
+ * @param nBest Number of best fitted individuals that need to be ranked.
+ * @param compare Strict ordering of the sort keys.
+ */
+template<class Compare>
+void IPopulation::rank(int nBest, Compare compare)
+{
   int n = size();
-  while (n > 0) {
-    int newn = 0;
-    for (int i = 1; i<=n-1; i++) {
-      if ( m_fom->isBetterThan(m_individuals[i], m_individuals[i-1]) ) {
-	IModel *temp = m_individuals[i];
-	m_individuals[i] = m_individuals[i-1];
-	m_individuals[i-1] = temp;
-	newn = i;
-      }
-    }
-    n = newn;
+  
+  m_rankKeys.resize(n);
+  for(int i=0; i<n; i++) {
+    m_rankKeys[i].score = m_individuals[i]->getScore();
+    m_rankKeys[i].index = i;
+    m_rankKeys[i].model = m_individuals[i];
+  }
+
+  if(nBest < n) {
+    std::nth_element(m_rankKeys.begin(), m_rankKeys.begin()+nBest, m_rankKeys.end(), compare);
   }
+  std::sort(m_rankKeys.begin(), m_rankKeys.begin()+nBest, compare);
+
+  m_rankBuffer.resize(n);
+  for(int i=0; i<n; i++) {
+    m_rankBuffer[i] = m_rankKeys[i].model;
+  }
+  m_individuals.swap(m_rankBuffer);
+
+  m_nRanked = nBest;
+}
+
+/**
+ * @return The number of best fitted individuals among which parents are selected.
+ */
+int IPopulation::selectionSize()
+{
+  if(m_selectionWindow > 0 && m_selectionWindow < size()) return m_selectionWindow;
+  return size();
+}
+
+/**
+ * Models are recycled by type of population: the returned model was created by a population of the same type
+ * as this one, and should be reset before use. Derived classes should call this method before creating a model,
+ * such that their models are recycled when the population is cleared.
+ *
+ * @return A recycled model owned by the caller, or 0 if a new model should be created.
+ */
+IModel *IPopulation::acquireModel()
+{
+  m_modelOwner = &typeid(*this);
+  return m_modelPool->acquire(*m_modelOwner);
 }
 
+/**
+ * Streams are identified by the random seed, the number of generations bred since the initialization,
+ * the individual and the operation: calling this method twice with the same arguments in the same
+ * generation returns the same stream.
+ *
+ * @param individual Index of the individual (e.g. of the offspring during cross-over).
+ * @param operation Operation using the stream (see RandomStream::Operation).
+ * @return A random stream positioned at its beginning.
+ */
+RandomStream IPopulation::getRandomStream(int individual, int operation)
+{
+  return RandomStream(m_seed, m_generation, individual, operation);
+}
 
 void IPopulation::checkFigureOfMerit()
 {
@@ -215,21 +979,121 @@ void IPopulation::checkFigureOfMerit()
 }
 
 /**
- * @param p1 Returns the index of the first parent.
- * @param p2 Returns the index of the second parent.
+ * The default is `false`, such that cross-over and mutation are performed serially.
+ *
+ * Derived classes should return `true` only if doCrossOver() can be called concurrently for disjoint
+ * ranges of offspring, and doMutate() for different models, i.e. if they only read the current generation
+ * and only write to the given offspring or model.
+ *
+ * @return true if cross-over and mutation are thread-safe.
+ */
+bool IPopulation::isBreedingThreadSafe() const
+{
+  return false;
+}
+
+/**
+ * The default implementation uses the parent selector (see setParentSelector()) among the
+ * selectionSize() best fitted individuals, whose scores are stored in m_parentScores.
+ * During steady-state evolution, the selection is further restricted to the ranked individuals.
+ *
+ * @param nPairs Number of offspring.
+ * @param parents Returns the 2*nPairs parent indices, the parents of the i-th offspring being at positions 2i and 2i+1.
+ */
+void IPopulation::selectParents(int nPairs, int *parents)
+{
+  int n = selectionSize() < m_nRanked ? selectionSize() : m_nRanked;
+  m_parentSelector->prepare(n, &m_parentScores[0]);
+  RandomStream random = getRandomStream(0, RandomStream::kSelection);
+  m_parentSelector->select(nPairs, parents, random);
+}
+
+/**
+ * @param begin Index of the first individual to be mutated.
+ * @param end Index after the last individual to be mutated.
+ */
+void IPopulation::mutateRange(int begin, int end)
+{
+  for(int i=begin; i<end; i++) {
+    RandomStream random = getRandomStream(i, RandomStream::kMutation);
+    double f = random.Rndm();
+    if(f < m_mutateRate) {
+      doMutate(m_individuals[i], random);
+      m_individuals[i]->setDirty();
+    }
+  }
+}
+
+/**
+ * Individuals whose score is out of date are looked up in the fitness cache, and the remaining ones
+ * are evaluated through IFigureOfMerit::evaluateBatch(), either all at once, or for each chunk of
+ * individuals when using several threads.
+ *
+ * @param begin Index of the first individual to be scored.
+ * @param end Index after the last individual to be scored.
+ * @return Number of individuals whose score was updated.
  */
-void IPopulation::selectParents(int &p1, int &p2)
+int IPopulation::scoreRange(int begin, int end)
 {
+  StageTimer timer(m_instrumented ? &m_stats.scoreTime : 0);
+  int nUpdated = findUnscored(begin, end, m_toScore);
 
-  int f1 = 0;
-  int f2 = 0;
-  do {
-    f1 = m_random->Integer(size());
-    p1 = m_random->Integer(size());
-  }while(p1 > f1);
-  do{
-    f2 = m_random->Integer(size());
-    p2 = m_random->Integer(size());    
+  int n = m_toScore.size();
+  m_scores.resize(size());
+  if(n > 0) {
+    if(m_threadPool && m_fom->isThreadSafe()) {
+      m_threadPool->parallelFor(n, m_chunkSize, [this](int first, int last) {
+	  m_fom->evaluateBatch(&m_toScore[first], last-first, &m_scores[first]);
+	});
+    }else{
+      m_fom->evaluateBatch(&m_toScore[0], n, &m_scores[0]);
+    }
+    setScores(&m_toScore[0], n, &m_scores[0]);
+  }
+  return nUpdated;
+}
+
+/**
+ * @param n Number of scores in the sums.
+ */
+void IPopulation::updateScoreMoments(int n)
+{
+  m_scoreMean = m_scoreSum/n;
+  m_scoreRMS = m_scoreSum2/n - m_scoreMean*m_scoreMean;
+  if(m_scoreRMS<0) m_scoreRMS = 0;
+  m_scoreRMS = sqrt(m_scoreRMS);
+}
+
+/**
+ * The individuals before begin are ranked, and the scores of the ranked individuals are stored in m_parentScores.
+ * The new individuals are ranked, then merged from the end of the range, such that only the individuals
+ * ranked below the best new individual are moved. New individuals are ranked after existing individuals with
+ * equivalent scores.
+ *
+ * @param begin Index of the first new individual.
+ * @param n Index after the last new individual.
+ * @param compare Strict ordering of the models.
+ */
+template<class Compare>
+void IPopulation::insertRanked(int begin, int n, Compare compare)
+{
+  std::sort(m_individuals.begin()+begin, m_individuals.begin()+n, compare);
+  m_rankBuffer.assign(m_individuals.begin()+begin, m_individuals.begin()+n);
+
+  int i = begin-1;
+  int j = n-begin-1;
+  for(int dst=n-1; j>=0; dst--) {
+    if(i >= 0 && compare(m_rankBuffer[j], m_individuals[i])) {
+      m_individuals[dst] = m_individuals[i];
+      m_parentScores[dst] = m_parentScores[i];
+      i--;
+    }else{
+      m_individuals[dst] = m_rankBuffer[j];
+      m_parentScores[dst] = m_rankBuffer[j]->getScore();
+      j--;
+    }
   }
-  while(p1 == p2 || p2 > f2);
-} 
+
+  m_nRanked = n;
+  m_rankedScoresValid = true;
+}
@@ -0,0 +1,19 @@
+#include "ITerminationPolicy.h"
+
+ITerminationPolicy::ITerminationPolicy()
+{
+}
+
+ITerminationPolicy::~ITerminationPolicy()
+{
+}
+
+/**
+ * The default implementation does nothing.
+ *
+ * @param population Population being optimized, initialized and scored.
+ * @param generation Number of the generation the optimization starts from, 0 unless resuming.
+ */
+void ITerminationPolicy::reset(IPopulation *population, int generation)
+{
+}
@@ -0,0 +1,78 @@
+#include "InstrumentationCounters.h"
+
+#ifdef GA_INSTRUMENTATION_COUNTERS
+#include <cstdlib>
+#include <new>
+
+std::atomic<long> InstrumentationCounters::m_randomDraws(0);
+std::atomic<long> InstrumentationCounters::m_allocations(0);
+
+void *operator new(std::size_t size)
+{
+  InstrumentationCounters::countAllocation();
+  void *ptr = std::malloc(size ? size : 1);
+  if(!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+#endif
+
+/**
+ * @return `true` if GA_INSTRUMENTATION_COUNTERS was defined when compiling the library.
+ */
+bool InstrumentationCounters::isEnabled()
+{
+#ifdef GA_INSTRUMENTATION_COUNTERS
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @return Number of random draws, or -1 if the counters are not compiled in.
+ */
+long InstrumentationCounters::getRandomDraws()
+{
+#ifdef GA_INSTRUMENTATION_COUNTERS
+  return m_randomDraws.load(std::memory_order_relaxed);
+#else
+  return -1;
+#endif
+}
+
+/**
+ * @return Number of heap allocations, or -1 if the counters are not compiled in.
+ */
+long InstrumentationCounters::getAllocations()
+{
+#ifdef GA_INSTRUMENTATION_COUNTERS
+  return m_allocations.load(std::memory_order_relaxed);
+#else
+  return -1;
+#endif
+}
@@ -0,0 +1,279 @@
+#include "IslandGeneticAlgorithm.h"
+#include "GeneticAlgorithm.h"
+#include "IModel.h"
+#include "IFigureOfMerit.h"
+#include "IPopulation.h"
+#include "ThreadPool.h"
+
+#include <stdexcept>
+#include <sstream>
+
+IslandGeneticAlgorithm::IslandGeneticAlgorithm()
+{
+  m_threadPool = 0;
+  m_generationsMax = 10000;
+  m_populationSize = 100;
+  m_currentGeneration = 0;
+  m_seed = 1234;
+  m_topology = kRing;
+  m_migrationInterval = 10;
+  m_nMigrants = 1;
+  m_genomeSize = 0;
+}
+
+IslandGeneticAlgorithm::~IslandGeneticAlgorithm()
+{
+  for(unsigned int i=0; i<m_algorithms.size(); i++) {
+    delete m_algorithms[i];
+  }
+  delete m_threadPool;
+}
+
+/**
+ * The population is not owned by this class.
+ *
+ * @param population Population to be evolved as an island.
+ */
+void IslandGeneticAlgorithm::addIsland(IPopulation *population)
+{
+  m_islands.push_back(population);
+}
+
+/**
+ * @return Number of islands.
+ */
+int IslandGeneticAlgorithm::getNIslands()
+{
+  return m_islands.size();
+}
+
+/**
+ * @param i Index of the island.
+ * @return Population of the island.
+ */
+IPopulation *IslandGeneticAlgorithm::getIsland(int i)
+{
+  if(i < 0 || i >= getNIslands()) {
+    std::ostringstream ostr;
+    ostr << "Island (" << i << ") is out of range [" << 0 << ", " << getNIslands() << "[";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  return m_islands[i];
+}
+
+/**
+ * @return Best fitted model across all islands after optimization.
+ */
+IModel *IslandGeneticAlgorithm::optimize()
+{
+
+  initialize();
+
+  while(nextEpoch());
+  
+  return getBestFitted();
+}
+
+/**
+ * Island \f$i\f$ is seeded with seed \f$+ i\f$, then all islands are initialized and scored in parallel.
+ */
+void IslandGeneticAlgorithm::initialize()
+{
+  if(m_islands.empty()) {
+    throw std::runtime_error("No island to evolve.");
+  }
+
+  for(unsigned int i=0; i<m_islands.size(); i++) {
+    IFigureOfMerit *fom = m_islands[i]->getFigureOfMerit();
+    if(!fom) {
+      throw std::runtime_error("Figure of merit not assigned for this population.");
+    }
+    for(unsigned int j=0; j<i; j++) {
+      if(m_islands[j]->getFigureOfMerit() == fom && !fom->isThreadSafe()) {
+	throw std::runtime_error("Islands can only share a thread-safe figure of merit.");
+      }
+    }
+  }
+
+  for(unsigned int i=0; i<m_algorithms.size(); i++) {
+    delete m_algorithms[i];
+  }
+  m_algorithms.resize(m_islands.size());
+  for(unsigned int i=0; i<m_islands.size(); i++) {
+    m_algorithms[i] = new GeneticAlgorithm();
+    m_algorithms[i]->setNGenerationsMax(m_generationsMax);
+    m_algorithms[i]->setPopulationSize(m_populationSize);
+    m_islands[i]->setRandomSeed(m_seed + i);
+  }
+  m_running.assign(m_islands.size(), 1);
+
+  if(!m_threadPool || m_threadPool->getNThreads() != getNIslands()) {
+    delete m_threadPool;
+    m_threadPool = new ThreadPool(getNIslands());
+  }
+
+  m_threadPool->parallelFor(getNIslands(), 1, [this](int begin, int end) {
+      for(int i=begin; i<end; i++) {
+	m_algorithms[i]->initialize(m_islands[i]);
+      }
+    });
+
+  m_genomeSize = m_islands[0]->getBestFitted()->getGenomeSize();
+  if(m_genomeSize <= 0 && m_nMigrants > 0 && getNIslands() > 1) {
+    throw std::runtime_error("Migrations require models exposing their genome.");
+  }
+  int nSources = m_topology == kRing ? 1 : getNIslands()-1;
+  m_migrantGenomes.resize(getNIslands()*m_nMigrants*m_genomeSize);
+  m_migrantScores.resize(getNIslands()*m_nMigrants);
+  m_incomingGenomes.resize(nSources*m_nMigrants*m_genomeSize);
+  m_incomingScores.resize(nSources*m_nMigrants);
+
+  m_currentGeneration = 0;
+}
+
+/**
+ * Each island is evolved on its own thread for the number of generations between two migrations.
+ *
+ * @return `true` if more generations are needed, `false` if an island reached an optimal solution
+ * or the maximum number of generations is reached.
+ */
+bool IslandGeneticAlgorithm::nextEpoch()
+{
+  m_threadPool->parallelFor(getNIslands(), 1, [this](int begin, int end) {
+      for(int i=begin; i<end; i++) {
+	for(int g=0; g<m_migrationInterval && m_running[i]; g++) {
+	  m_running[i] = m_algorithms[i]->nextGeneration();
+	}
+      }
+    });
+
+  bool running = true;
+  for(int i=0; i<getNIslands(); i++) {
+    if(m_algorithms[i]->getCurrentGeneration() > m_currentGeneration) {
+      m_currentGeneration = m_algorithms[i]->getCurrentGeneration();
+    }
+    if(!m_running[i]) running = false;
+  }
+  if(!running) return false;
+
+  migrate();
+
+  return true;
+}
+
+/**
+ * The migrants of all islands are copied first, such that an individual that just arrived at an island
+ * does not migrate further during the same migration. The number of individuals replaced in an island
+ * is limited to half of its population.
+ */
+void IslandGeneticAlgorithm::migrate()
+{
+  int nIslands = getNIslands();
+  if(nIslands < 2 || m_nMigrants <= 0) return;
+
+  for(int i=0; i<nIslands; i++) {
+    int n = m_nMigrants < m_islands[i]->size() ? m_nMigrants : m_islands[i]->size();
+    for(int r=0; r<n; r++) {
+      IModel *model = m_islands[i]->getBestFitted(r);
+      const double *genome = model->getGenome();
+      double *dest = &m_migrantGenomes[(i*m_nMigrants + r)*m_genomeSize];
+      for(int g=0; g<m_genomeSize; g++) dest[g] = genome[g];
+      m_migrantScores[i*m_nMigrants + r] = model->getScore();
+    }
+  }
+
+  for(int j=0; j<nIslands; j++) {
+    int n = 0;
+    int nMax = m_islands[j]->size()/2;
+    for(int k=1; k<nIslands && n<nMax; k++) {
+      int i = (j - k + nIslands) % nIslands;
+      int nFromIsland = m_nMigrants < m_islands[i]->size() ? m_nMigrants : m_islands[i]->size();
+      for(int r=0; r<nFromIsland && n<nMax; r++, n++) {
+	const double *genome = &m_migrantGenomes[(i*m_nMigrants + r)*m_genomeSize];
+	double *dest = &m_incomingGenomes[n*m_genomeSize];
+	for(int g=0; g<m_genomeSize; g++) dest[g] = genome[g];
+	m_incomingScores[n] = m_migrantScores[i*m_nMigrants + r];
+      }
+      if(m_topology == kRing) break;
+    }
+    m_islands[j]->replaceWorst(n, m_genomeSize, m_incomingGenomes.data(), m_incomingScores.data());
+  }
+}
+
+/**
+ * @return Best fitted model across all islands.
+ */
+IModel *IslandGeneticAlgorithm::getBestFitted()
+{
+  IModel *best = 0;
+  IFigureOfMerit *fom = 0;
+  for(int i=0; i<getNIslands(); i++) {
+    IModel *model = m_islands[i]->getBestFitted();
+    if(!best || fom->isBetterThan(model, best)) {
+      best = model;
+      fom = m_islands[i]->getFigureOfMerit();
+    }
+  }
+  return best;
+}
+
+/**
+ * @return Number of the current generation.
+ */
+int IslandGeneticAlgorithm::getCurrentGeneration()
+{
+  return m_currentGeneration;
+}
+
+/**
+ * @param generationsMax Desired maximum number of generations.
+ */
+void IslandGeneticAlgorithm::setNGenerationsMax(int generationsMax)
+{
+  m_generationsMax = generationsMax;
+}
+
+/**
+ * @param populationSize Desired population size of each island.
+ */
+void IslandGeneticAlgorithm::setPopulationSize(int populationSize)
+{
+  m_populationSize = populationSize;
+}
+
+/**
+ * @param seed Seed of the first island. Island \f$i\f$ uses seed \f$+ i\f$.
+ */
+void IslandGeneticAlgorithm::setRandomSeed(int seed)
+{
+  m_seed = seed;
+}
+
+/**
+ * @param topology Desired migration topology.
+ */
+void IslandGeneticAlgorithm::setTopology(Topology topology)
+{
+  m_topology = topology;
+}
+
+/**
+ * @param generations Number of generations between two migrations.
+ */
+void IslandGeneticAlgorithm::setMigrationInterval(int generations)
+{
+  if(generations < 1) {
+    std::ostringstream ostr;
+    ostr << "Migration interval (" << generations << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_migrationInterval = generations;
+}
+
+/**
+ * @param nMigrants Number of best fitted individuals sent by an island to each destination.
+ */
+void IslandGeneticAlgorithm::setNMigrants(int nMigrants)
+{
+  m_nMigrants = nMigrants > 0 ? nMigrants : 0;
+}
@@ -0,0 +1,68 @@
+#include "LinearRankSelector.h"
+
+#include <cmath>
+
+namespace {
+
+  /** Draws an integer uniformly in [0, n[, with n possibly larger than 2^32. */
+  long long drawInteger(long long n, RandomStream &random)
+  {
+    long long r = (long long)(random.Rndm()*n);
+    return r < n ? r : n-1;
+  }
+
+  /** Returns the triangular number j(j+1)/2. */
+  inline long long triangular(long long j)
+  {
+    return j*(j+1)/2;
+  }
+
+  /** Returns j such that triangular(j) <= r < triangular(j+1). */
+  long long invertTriangular(long long r)
+  {
+    long long j = (long long)((std::sqrt(8.*r+1.)-1.)/2.);
+    while(j > 0 && triangular(j) > r) j--;
+    while(triangular(j+1) <= r) j++;
+    return j;
+  }
+}
+
+LinearRankSelector::LinearRankSelector() :
+  IParentSelector()
+{
+}
+
+LinearRankSelector::~LinearRankSelector()
+{
+}
+
+/**
+ * The individuals are given integer weights \f$n-k\f$. Counting from the least fitted individual
+ * (\f$j=n-1-k\f$), the cumulative weights are the triangular numbers \f$j(j+1)/2\f$, which are inverted
+ * analytically. The second parent is drawn among the remaining weights, skipping the interval
+ * of the first parent, such that no rejection is needed.
+ *
+ * @param nPairs Number of offspring.
+ * @param parents Returns the 2*nPairs parent ranks, the parents of the i-th offspring being at positions 2i and 2i+1.
+ * @param random Random number generator.
+ */
+void LinearRankSelector::select(int nPairs, int *parents, RandomStream &random)
+{
+  long long n = m_n;
+  if(n <= 1) {
+    for(int i=0; i<2*nPairs; i++) {
+      parents[i] = 0;
+    }
+    return;
+  }
+
+  long long total = triangular(n);
+  for(int i=0; i<nPairs; i++) {
+    long long j1 = invertTriangular(drawInteger(total, random));
+    long long r = drawInteger(total - (j1+1), random);
+    if(r >= triangular(j1)) r += j1+1;
+    long long j2 = invertTriangular(r);
+    parents[2*i] = n-1-j1;
+    parents[2*i+1] = n-1-j2;
+  }
+}
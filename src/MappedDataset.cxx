@@ -0,0 +1,240 @@
+#include "MappedDataset.h"
+#include "ParametricModel.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const uint32_t MappedDataset::kVersion;
+const int MappedDataset::kHeaderSize;
+const int MappedDataset::kAlignment;
+
+namespace {
+
+  /** Magic string identifying a dataset file. */
+  const char kMagic[8] = {'G', 'A', 'D', 'A', 'T', 'A', 0, 0};
+
+  /** Header of a dataset file. */
+  struct Header {
+    char magic[8]; //!< Magic string.
+    uint32_t version; //!< Version of the format.
+    uint32_t ndim; //!< Number of dimensions.
+    uint64_t npoints; //!< Number of points.
+  };
+
+}
+
+MappedDataset::MappedDataset()
+{
+  m_mapping = 0;
+  m_size = 0;
+  m_npoints = 0;
+  m_ndim = 0;
+}
+
+/**
+ * @param path Path of the dataset file.
+ */
+MappedDataset::MappedDataset(const std::string &path)
+{
+  m_mapping = 0;
+  m_size = 0;
+  m_npoints = 0;
+  m_ndim = 0;
+  open(path);
+}
+
+MappedDataset::~MappedDataset()
+{
+  close();
+}
+
+/**
+ * Any previously mapped file is closed first.
+ * Throws an exception if the file cannot be mapped or is not a valid dataset file.
+ *
+ * @param path Path of the dataset file.
+ */
+void MappedDataset::open(const std::string &path)
+{
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0) {
+    std::ostringstream ostr;
+    ostr << "Failed to open dataset " << path << ": " << strerror(errno);
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  struct stat status;
+  if(fstat(fd, &status) < 0 || status.st_size < kHeaderSize) {
+    ::close(fd);
+    std::ostringstream ostr;
+    ostr << "Dataset " << path << " is truncated";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  void *mapping = mmap(0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(mapping == MAP_FAILED) {
+    std::ostringstream ostr;
+    ostr << "Failed to map dataset " << path << ": " << strerror(errno);
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  Header header;
+  memcpy(&header, mapping, sizeof(header));
+  std::ostringstream error;
+  if(memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    error << "File " << path << " is not a dataset";
+  }else if(header.version != kVersion) {
+    error << "Dataset " << path << " has version " << header.version << ", expected " << kVersion;
+  }else if(header.ndim < 1 || header.ndim > (uint32_t)ParametricModel::kMaxDimensions) {
+    error << "Dataset " << path << " has " << header.ndim << " dimensions, expected 1 to " << ParametricModel::kMaxDimensions;
+  }else if(header.npoints > ((uint64_t)status.st_size - kHeaderSize) / ((header.ndim+2)*sizeof(double))
+	   || (uint64_t)status.st_size < columnOffset(header.ndim+2, header.npoints)) {
+    // The number of points is bounded first, such that the offset of the end of the columns does not overflow
+    error << "Dataset " << path << " is truncated";
+  }
+  if(!error.str().empty()) {
+    munmap(mapping, status.st_size);
+    throw std::runtime_error(error.str().c_str());
+  }
+
+  // The columns are read sequentially by the figure of merit.
+  madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+
+  m_mapping = mapping;
+  m_size = status.st_size;
+  m_npoints = header.npoints;
+  m_ndim = header.ndim;
+}
+
+void MappedDataset::close()
+{
+  if(m_mapping) {
+    munmap(m_mapping, m_size);
+  }
+  m_mapping = 0;
+  m_size = 0;
+  m_npoints = 0;
+  m_ndim = 0;
+}
+
+/**
+ * @return true if a file is mapped.
+ */
+bool MappedDataset::isOpen() const
+{
+  return m_mapping != 0;
+}
+
+/**
+ * @return Number of points.
+ */
+long MappedDataset::getNPoints() const
+{
+  return m_npoints;
+}
+
+/**
+ * @return Number of dimensions.
+ */
+int MappedDataset::getNDimensions() const
+{
+  return m_ndim;
+}
+
+/**
+ * @param d Index of the coordinate.
+ * @return Array of the n values of the coordinate.
+ */
+const double *MappedDataset::getX(int d) const
+{
+  return (const double*)((const char*)m_mapping + columnOffset(d, m_npoints));
+}
+
+/**
+ * @return Array of the n values.
+ */
+const double *MappedDataset::getY() const
+{
+  return (const double*)((const char*)m_mapping + columnOffset(m_ndim, m_npoints));
+}
+
+/**
+ * @return Array of the n errors on the values.
+ */
+const double *MappedDataset::getEY() const
+{
+  return (const double*)((const char*)m_mapping + columnOffset(m_ndim+1, m_npoints));
+}
+
+/**
+ * The columns are written one after the other, such that the whole dataset never needs
+ * to be held in memory in the file layout.
+ * Throws an exception if the file cannot be written.
+ *
+ * @param path Path of the dataset file.
+ * @param n Number of points.
+ * @param ndim Number of dimensions of \f$\vec{x}\f$.
+ * @param x Array of ndim columns of n coordinates.
+ * @param y Array of the n values.
+ * @param ey Array of the n errors on the values.
+ */
+void MappedDataset::write(const std::string &path, long n, int ndim, const double *const *x, const double *y, const double *ey)
+{
+  if(n < 0 || ndim < 1 || ndim > ParametricModel::kMaxDimensions) {
+    std::ostringstream ostr;
+    ostr << "Invalid dataset of " << n << " points in " << ndim << " dimensions";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  if(!out) {
+    std::ostringstream ostr;
+    ostr << "Failed to create dataset " << path;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  std::vector<char> header(kHeaderSize, 0);
+  Header fields;
+  memcpy(fields.magic, kMagic, sizeof(kMagic));
+  fields.version = kVersion;
+  fields.ndim = ndim;
+  fields.npoints = n;
+  memcpy(header.data(), &fields, sizeof(fields));
+  out.write(header.data(), header.size());
+
+  std::vector<char> padding(kAlignment, 0);
+  for(int column=0; column<ndim+2; column++) {
+    const double *values = column < ndim ? x[column] : column == ndim ? y : ey;
+    out.write((const char*)values, n*sizeof(double));
+    out.write(padding.data(), columnOffset(column+1, n) - columnOffset(column, n) - n*sizeof(double));
+  }
+
+  if(!out) {
+    std::ostringstream ostr;
+    ostr << "Failed to write dataset " << path;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+}
+
+/**
+ * @param column Index of the column: the coordinates of \f$\vec{x}\f$, then \f$y\f$, then \f$\sigma_y\f$.
+ * @param n Number of points.
+ * @return Offset of the column from the beginning of the file.
+ */
+uint64_t MappedDataset::columnOffset(int column, long n)
+{
+  uint64_t stride = ((uint64_t)n*sizeof(double) + kAlignment - 1) / kAlignment * kAlignment;
+  return kHeaderSize + column*stride;
+}
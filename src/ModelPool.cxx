@@ -0,0 +1,60 @@
+#include "ModelPool.h"
+
+#include "IModel.h"
+
+ModelPool::ModelPool()
+{
+}
+
+ModelPool::~ModelPool()
+{
+  clear();
+}
+
+/**
+ * @param owner Type of the population requesting a model.
+ * @return A model created by a population of the same type, owned by the caller, or 0 if there is none.
+ */
+IModel *ModelPool::acquire(const std::type_info &owner)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::map<std::type_index, std::vector<IModel*> >::iterator it = m_models.find(std::type_index(owner));
+  if(it == m_models.end() || it->second.empty()) return 0;
+  IModel *model = it->second.back();
+  it->second.pop_back();
+  return model;
+}
+
+/**
+ * @param owner Type of the population that created the model.
+ * @param model Model given to the pool, which takes its ownership.
+ */
+void ModelPool::release(const std::type_info &owner, IModel *model)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_models[std::type_index(owner)].push_back(model);
+}
+
+/**
+ * @return Number of models in the pool, for all types of populations.
+ */
+int ModelPool::size()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  int n = 0;
+  for(std::map<std::type_index, std::vector<IModel*> >::iterator it = m_models.begin(); it != m_models.end(); ++it) {
+    n += it->second.size();
+  }
+  return n;
+}
+
+void ModelPool::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for(std::map<std::type_index, std::vector<IModel*> >::iterator it = m_models.begin(); it != m_models.end(); ++it) {
+    for(unsigned int i=0; i<it->second.size(); i++) {
+      delete it->second[i];
+    }
+  }
+  m_models.clear();
+}
@@ -0,0 +1,594 @@
+#include "MultiProcessFigureOfMerit.h"
+
+#include "IModel.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+
+namespace {
+
+  /** Returns a monotonic time in seconds. */
+  double now()
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /** Sends a buffer completely. Returns false on error. */
+  bool sendAll(int socket, const void *buffer, size_t size)
+  {
+    const char *ptr = (const char*)buffer;
+    while(size > 0) {
+      ssize_t n = send(socket, ptr, size, MSG_NOSIGNAL);
+      if(n < 0 && errno == EINTR) continue;
+      if(n <= 0) return false;
+      ptr += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  /** Receives a buffer completely. Returns false on error or end of stream. */
+  bool receiveAll(int socket, void *buffer, size_t size)
+  {
+    char *ptr = (char*)buffer;
+    while(size > 0) {
+      ssize_t n = recv(socket, ptr, size, 0);
+      if(n < 0 && errno == EINTR) continue;
+      if(n <= 0) return false;
+      ptr += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  /** Requests of the master to the spawner. */
+  enum SpawnerRequest {
+    kStartWorker, //!< Fork a worker and send back its pid and socket.
+    kStopWorker //!< Kill a worker and send back its pid once it is reaped.
+  };
+
+  /** Sends an integer and optionally a file descriptor (if fd >= 0). Returns false on error. */
+  bool sendDescriptor(int socket, int fd, int value)
+  {
+    struct iovec iov;
+    iov.iov_base = &value;
+    iov.iov_len = sizeof(value);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    char control[CMSG_SPACE(sizeof(int))];
+    if(fd >= 0) {
+      memset(control, 0, sizeof(control));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+      memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    ssize_t n;
+    do {
+      n = sendmsg(socket, &msg, MSG_NOSIGNAL);
+    } while(n < 0 && errno == EINTR);
+    return n == sizeof(value);
+  }
+
+  /** Receives an integer and optionally a file descriptor (-1 if none). Returns false on error. */
+  bool receiveDescriptor(int socket, int &fd, int &value)
+  {
+    struct iovec iov;
+    iov.iov_base = &value;
+    iov.iov_len = sizeof(value);
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+      n = recvmsg(socket, &msg, 0);
+    } while(n < 0 && errno == EINTR);
+    fd = -1;
+    struct cmsghdr *cmsg = n > 0 ? CMSG_FIRSTHDR(&msg) : 0;
+    if(cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    return n == sizeof(value);
+  }
+
+}
+
+/**
+ * The wrapped figure of merit is not owned, and should outlive this object.
+ *
+ * @param fom Figure of merit evaluated by the worker processes.
+ * @param nWorkers Number of worker processes.
+ */
+MultiProcessFigureOfMerit::MultiProcessFigureOfMerit(IFigureOfMerit *fom, int nWorkers) :
+  IFigureOfMerit()
+{
+  if(!fom) {
+    throw std::runtime_error("Figure of merit is not set");
+  }
+  if(nWorkers < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of workers (" << nWorkers << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  m_fom = fom;
+  m_batchSize = 0;
+  m_timeout = 60;
+  m_maxRetries = 2;
+  m_genomeSize = 0;
+  m_spawner = -1;
+  m_spawnerSocket = -1;
+
+  Worker worker;
+  worker.pid = -1;
+  worker.socket = -1;
+  worker.batch = -1;
+  worker.start = 0;
+  m_workers.resize(nWorkers, worker);
+}
+
+MultiProcessFigureOfMerit::~MultiProcessFigureOfMerit()
+{
+  stopWorkers();
+}
+
+/**
+ * @param model The model to be evaluated.
+ * @return The score of the model.
+ */
+double MultiProcessFigureOfMerit::evaluate(IModel *model) const
+{
+  double score;
+  evaluateBatch(&model, 1, &score);
+  return score;
+}
+
+/**
+ * The workers should be started (see startWorkers()), and the models should expose their genome
+ * (see IModel::getGenome()) with the genome size of the prototype given to the workers.
+ *
+ * The batches are distributed dynamically to idle workers. If a worker crashes or does not answer
+ * within the timeout, it is replaced and its batch is sent again. If the evaluation fails, the workers
+ * still evaluating a batch are replaced, such that their answers are not taken for those of the next call.
+ *
+ * @param models Array of models to be evaluated.
+ * @param n Number of models.
+ * @param scores Array of n scores to be filled.
+ */
+void MultiProcessFigureOfMerit::evaluateBatch(IModel *const *models, int n, double *scores) const
+{
+  if(n <= 0) return;
+
+  if(m_spawner < 0) {
+    throw std::runtime_error("Worker processes are not started (see MultiProcessFigureOfMerit::startWorkers())");
+  }
+  abandonBatches();
+
+  int genomeSize = m_genomeSize;
+
+  m_genomes.resize((size_t)n*genomeSize);
+  for(int i=0; i<n; i++) {
+    if(models[i]->getGenomeSize() != genomeSize) {
+      std::ostringstream ostr;
+      ostr << "Genome size (" << models[i]->getGenomeSize() << ") differs from the prototype of the workers (" << genomeSize << ")";
+      throw std::runtime_error(ostr.str().c_str());
+    }
+    const double *genome = models[i]->getGenome();
+    std::copy(genome, genome+genomeSize, m_genomes.begin() + (size_t)i*genomeSize);
+  }
+
+  int nWorkers = m_workers.size();
+  int batchSize = m_batchSize;
+  if(batchSize <= 0) batchSize = (n + 4*nWorkers - 1)/(4*nWorkers);
+
+  int nBatches = (n + batchSize - 1)/batchSize;
+  m_batchBegin.resize(nBatches+1);
+  m_batchRetries.assign(nBatches, 0);
+  m_pending.resize(nBatches);
+  for(int b=0; b<nBatches; b++) {
+    m_batchBegin[b] = b*batchSize;
+    m_pending[b] = nBatches-1-b; // batches are popped from the back
+  }
+  m_batchBegin[nBatches] = n;
+
+  std::vector<struct pollfd> fds;
+  std::vector<int> polled;
+  int nDone = 0;
+
+  while(nDone < nBatches) {
+
+    // Send pending batches to idle workers
+    for(int w=0; w<nWorkers && !m_pending.empty(); w++) {
+      Worker &worker = m_workers[w];
+      if(worker.batch >= 0) continue;
+      if(worker.pid < 0) startWorker(w);
+
+      int b = m_pending.back();
+      m_pending.pop_back();
+      int header[2] = {m_batchBegin[b+1] - m_batchBegin[b], genomeSize};
+      worker.batch = b;
+      worker.start = now();
+      if(!sendAll(worker.socket, header, sizeof(header)) ||
+	 !sendAll(worker.socket, &m_genomes[(size_t)m_batchBegin[b]*genomeSize], sizeof(double)*header[0]*genomeSize)) {
+	worker.start = -1; // failed, handled below
+      }
+    }
+
+    // Wait for the results
+    fds.clear();
+    polled.clear();
+    double wait = -1;
+    double t = now();
+    for(int w=0; w<nWorkers; w++) {
+      const Worker &worker = m_workers[w];
+      if(worker.batch < 0 || worker.start < 0) continue;
+      struct pollfd fd;
+      fd.fd = worker.socket;
+      fd.events = POLLIN;
+      fd.revents = 0;
+      fds.push_back(fd);
+      polled.push_back(w);
+      if(m_timeout > 0) {
+	double remaining = worker.start + m_timeout - t;
+	if(remaining < 0) remaining = 0;
+	if(wait < 0 || remaining < wait) wait = remaining;
+      }
+    }
+    if(!fds.empty()) {
+      int timeout = wait < 0 ? -1 : (int)(wait*1000) + 1;
+      int ready = poll(&fds[0], fds.size(), timeout);
+      if(ready < 0 && errno != EINTR) {
+	abandonBatches();
+	std::ostringstream ostr;
+	ostr << "Failed to wait for workers: " << strerror(errno);
+	throw std::runtime_error(ostr.str().c_str());
+      }
+    }
+
+    // Collect the results and replace failed workers
+    t = now();
+    for(int w=0; w<nWorkers; w++) {
+      Worker &worker = m_workers[w];
+      if(worker.batch < 0) continue;
+      int b = worker.batch;
+
+      bool failed = worker.start < 0;
+      if(!failed) {
+	short revents = 0;
+	for(unsigned int i=0; i<polled.size(); i++) {
+	  if(polled[i] == w) revents = fds[i].revents;
+	}
+	if(revents) {
+	  int begin = m_batchBegin[b];
+	  failed = !receiveAll(worker.socket, scores+begin, sizeof(double)*(m_batchBegin[b+1]-begin));
+	  if(!failed) {
+	    worker.batch = -1;
+	    nDone++;
+	    continue;
+	  }
+	}else if(m_timeout > 0 && t - worker.start > m_timeout) {
+	  failed = true;
+	}
+      }
+
+      if(failed) {
+	killWorker(w);
+	if(++m_batchRetries[b] > m_maxRetries) {
+	  abandonBatches();
+	  std::ostringstream ostr;
+	  ostr << "Evaluation of models " << m_batchBegin[b] << " to " << m_batchBegin[b+1]-1
+	       << " failed " << m_batchRetries[b] << " times";
+	  throw std::runtime_error(ostr.str().c_str());
+	}
+	m_pending.push_back(b);
+      }
+    }
+  }
+}
+
+/**
+ * The decision is delegated to the wrapped figure of merit.
+ *
+ * @param model The model to be tested.
+ * @return true if the model can be accepted.
+ */
+bool MultiProcessFigureOfMerit::accept(IModel *model) const
+{
+  return m_fom->accept(model);
+}
+
+/**
+ * The comparison is delegated to the wrapped figure of merit.
+ *
+ * @param modelToTest The model to be tested.
+ * @param referenceModel The model to compare to.
+ * @return true if modelToTest is better than referenceModel, false otherwise.
+ */
+bool MultiProcessFigureOfMerit::isBetterThan(IModel *modelToTest, IModel *referenceModel) const
+{
+  return m_fom->isBetterThan(modelToTest, referenceModel);
+}
+
+/**
+ * The comparison is delegated to the wrapped figure of merit.
+ *
+ * @param scoreToTest The score of the model to be tested.
+ * @param referenceScore The score of the model to compare to.
+ * @return true if scoreToTest is better than referenceScore, false otherwise.
+ */
+bool MultiProcessFigureOfMerit::isBetterThan(double scoreToTest, double referenceScore) const
+{
+  return m_fom->isBetterThan(scoreToTest, referenceScore);
+}
+
+/**
+ * @return true if the wrapped figure of merit ranks models on their scores.
+ */
+bool MultiProcessFigureOfMerit::ranksOnScore() const
+{
+  return m_fom->ranksOnScore();
+}
+
+/**
+ * Smaller batches balance the load better, larger batches reduce the communication overhead.
+ *
+ * @param batchSize Number of models per batch, or 0 to split the models in 4 batches per worker.
+ */
+void MultiProcessFigureOfMerit::setBatchSize(int batchSize)
+{
+  m_batchSize = batchSize;
+}
+
+/**
+ * The timeout applies to the evaluation of a whole batch. The default is 60 seconds.
+ *
+ * @param seconds Timeout in seconds, or 0 to wait forever.
+ */
+void MultiProcessFigureOfMerit::setTimeout(double seconds)
+{
+  m_timeout = seconds;
+}
+
+/**
+ * @param maxRetries Number of times a batch is sent again after a crash or a timeout before giving up.
+ */
+void MultiProcessFigureOfMerit::setMaxRetries(int maxRetries)
+{
+  m_maxRetries = maxRetries;
+}
+
+/**
+ * Forking a process that runs several threads is unsafe, since the threads are not copied while the locks
+ * they hold are. This function forks a single process, the spawner, which then forks all the workers,
+ * and later the replacements of the workers that failed: the spawner never runs any other thread.
+ * It should therefore be called before any thread is started, e.g. before IPopulation::setNThreads(),
+ * or before starting a CheckpointWriter or a TraceWriter.
+ *
+ * The workers hold a copy of the wrapped figure of merit and of the prototype as they are when this function
+ * is called. Workers already running are stopped first.
+ *
+ * @param prototype Model into which the genomes are loaded in the workers, exposing its genome
+ * (see IModel::getGenome()).
+ */
+void MultiProcessFigureOfMerit::startWorkers(IModel *prototype)
+{
+  if(!prototype || prototype->getGenomeSize() <= 0) {
+    throw std::runtime_error("Model does not expose a genome");
+  }
+
+  stopWorkers();
+
+  int sockets[2];
+  if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+    std::ostringstream ostr;
+    ostr << "Failed to create socket: " << strerror(errno);
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  pid_t pid = fork();
+  if(pid < 0) {
+    close(sockets[0]);
+    close(sockets[1]);
+    std::ostringstream ostr;
+    ostr << "Failed to start the spawner of the workers: " << strerror(errno);
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  if(pid == 0) {
+    close(sockets[0]);
+    spawn(sockets[1], prototype);
+    _exit(0);
+  }
+
+  close(sockets[1]);
+  m_spawner = pid;
+  m_spawnerSocket = sockets[0];
+  m_genomeSize = prototype->getGenomeSize();
+
+  for(unsigned int w=0; w<m_workers.size(); w++) {
+    startWorker(w);
+  }
+}
+
+/**
+ * The workers and the spawner need to be started again with startWorkers() before the next evaluation.
+ * This should be done when the wrapped figure of merit changes, e.g. when data are added,
+ * since the workers hold a copy of it.
+ */
+void MultiProcessFigureOfMerit::stopWorkers() const
+{
+  for(unsigned int w=0; w<m_workers.size(); w++) {
+    killWorker(w);
+  }
+  if(m_spawnerSocket >= 0) {
+    close(m_spawnerSocket);
+    m_spawnerSocket = -1;
+  }
+  if(m_spawner > 0) {
+    while(waitpid(m_spawner, 0, 0) < 0 && errno == EINTR) {}
+    m_spawner = -1;
+  }
+}
+
+/**
+ * The worker process is forked by the spawner, which sends back its pid and the socket connected to it.
+ *
+ * @param w Index of the worker.
+ */
+void MultiProcessFigureOfMerit::startWorker(int w) const
+{
+  int request[2] = {kStartWorker, 0};
+  int socket = -1;
+  int pid = -1;
+  if(!sendAll(m_spawnerSocket, request, sizeof(request)) || !receiveDescriptor(m_spawnerSocket, socket, pid)
+     || pid <= 0 || socket < 0) {
+    if(socket >= 0) close(socket);
+    std::ostringstream ostr;
+    ostr << "Failed to start worker";
+    if(pid < 0) ostr << ": " << strerror(-pid);
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  if(m_timeout > 0) {
+    // Bounds the time spent sending to a worker that stopped reading
+    struct timeval tv;
+    tv.tv_sec = (long)m_timeout;
+    tv.tv_usec = (long)((m_timeout - tv.tv_sec)*1e6);
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  }
+
+  Worker &worker = m_workers[w];
+  worker.pid = pid;
+  worker.socket = socket;
+  worker.batch = -1;
+  worker.start = 0;
+}
+
+/**
+ * The worker is killed and reaped by the spawner, whose child it is.
+ *
+ * @param w Index of the worker.
+ */
+void MultiProcessFigureOfMerit::killWorker(int w) const
+{
+  Worker &worker = m_workers[w];
+  if(worker.socket >= 0) {
+    close(worker.socket);
+    worker.socket = -1;
+  }
+  if(worker.pid > 0) {
+    int request[2] = {kStopWorker, worker.pid};
+    int answer;
+    if(!sendAll(m_spawnerSocket, request, sizeof(request)) || !receiveAll(m_spawnerSocket, &answer, sizeof(answer))) {
+      kill(worker.pid, SIGKILL);
+    }
+    worker.pid = -1;
+  }
+  worker.batch = -1;
+}
+
+/**
+ * Workers still evaluating a batch are killed, since their answer may be in flight, and are replaced
+ * at the next evaluation. The pending batches are dropped.
+ */
+void MultiProcessFigureOfMerit::abandonBatches() const
+{
+  for(unsigned int w=0; w<m_workers.size(); w++) {
+    if(m_workers[w].batch >= 0) killWorker(w);
+  }
+  m_pending.clear();
+}
+
+/**
+ * Each request consists of its type and of the pid of the worker to stop. Workers are forked with a copy of
+ * the prototype, and keep only their end of the socket connected to the master. The loop ends when the master
+ * closes the socket: the remaining workers then see their socket closed and exit.
+ *
+ * @param socket Socket connected to the master.
+ * @param prototype Model into which the genomes are loaded in the workers.
+ */
+void MultiProcessFigureOfMerit::spawn(int socket, IModel *prototype) const
+{
+  int request[2];
+  while(receiveAll(socket, request, sizeof(request))) {
+    if(request[0] == kStopWorker) {
+      pid_t pid = request[1];
+      kill(pid, SIGKILL);
+      while(waitpid(pid, 0, 0) < 0 && errno == EINTR) {}
+      if(!sendAll(socket, &request[1], sizeof(request[1]))) break;
+      continue;
+    }
+
+    int sockets[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+      if(!sendDescriptor(socket, -1, -errno)) break;
+      continue;
+    }
+    pid_t pid = fork();
+    if(pid == 0) {
+      close(socket);
+      close(sockets[0]);
+      serve(sockets[1], prototype);
+      _exit(0);
+    }
+    int error = errno;
+    close(sockets[1]);
+    bool sent = pid > 0 ? sendDescriptor(socket, sockets[0], pid) : sendDescriptor(socket, -1, -error);
+    close(sockets[0]);
+    if(!sent) break;
+  }
+  close(socket);
+}
+
+/**
+ * Each request consists of the number of models and the genome size, followed by the genomes.
+ * The answer consists of the scores. The loop ends when the master closes the socket.
+ * If the evaluation throws an exception, the worker exits, which the master handles as a crash.
+ *
+ * @param socket Socket connected to the master.
+ * @param prototype Model into which the genomes are loaded.
+ */
+void MultiProcessFigureOfMerit::serve(int socket, IModel *prototype) const
+{
+  std::vector<double> genomes;
+  std::vector<double> scores;
+  int header[2];
+
+  try {
+    while(receiveAll(socket, header, sizeof(header))) {
+      genomes.resize((size_t)header[0]*header[1]);
+      scores.resize(header[0]);
+      if(!receiveAll(socket, &genomes[0], sizeof(double)*genomes.size())) break;
+      for(int i=0; i<header[0]; i++) {
+	prototype->setGenome(&genomes[(size_t)i*header[1]]);
+	scores[i] = m_fom->evaluate(prototype);
+      }
+      if(!sendAll(socket, &scores[0], sizeof(double)*scores.size())) break;
+    }
+  }catch(...) {
+    _exit(1);
+  }
+  close(socket);
+}
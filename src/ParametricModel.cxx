@@ -3,16 +3,19 @@
 #include <stdexcept>
 #include <sstream>
 
+const int ParametricModel::kMaxDimensions;
+
 ParametricModel::ParametricModel() :
   IModel()
 {
   m_formula=0;
+  m_parameters=0;
 }
 
 ParametricModel::~ParametricModel()
 {
-  // The formula is a clone that we own.
-  if(m_formula) delete m_formula;
+  // The formula is a clone that we own, unless this model is a view.
+  if(m_formula && !m_parameters) delete m_formula;
 }
 
 /**
@@ -20,32 +23,196 @@ ParametricModel::~ParametricModel()
  *
  * This function keeps a clone of the formula in order to make sure that modifying it later
  * does not affect other instances that might share the same original formula. 
+ *
+ * If this model already owns a clone describing the same function (see isSameFunction()), e.g. when it is
+ * recycled by a population (see ModelPool), the clone is kept and only its parameters are reset to those
+ * of the formula.
  */
 void ParametricModel::setFormula(TF1 *formula)
 {
 
-  if(m_formula) delete m_formula;
+  if(m_formula && !m_parameters && isSameFunction(m_formula, formula)) {
+    m_formula->SetParameters(formula->GetParameters());
+    return;
+  }
+  if(m_formula && !m_parameters) delete m_formula;
   m_formula = (TF1*)formula->Clone();
+  m_parameters = 0;
+}
+
+/**
+ * The model does not own the formula nor the parameters: both should outlive the model.
+ * The formula can be shared by many views, as evaluating a view does not modify it.
+ *
+ * @param formula A <a href="https://root.cern.ch/doc/v610/classTF1.html">TF1</a> formula.
+ * @param parameters Array of values for the formula's parameters.
+ */
+void ParametricModel::setView(TF1 *formula, double *parameters)
+{
+
+  if(m_formula && !m_parameters) delete m_formula;
+  m_formula = formula;
+  m_parameters = parameters;
 }
 
 /**
+ * Formulas are compared by content rather than by address: a formula deleted after a fit and a new one
+ * allocated for the next fit may have the same address. The functions are the same if they have the same
+ * expression, number of dimensions, number of parameters and range. Functions without an expression,
+ * e.g. defined by C++ code, cannot be compared and are never considered the same.
+ *
+ * @param clone Clone of a formula.
+ * @param formula Formula to compare to.
+ * @return true if the clone can be used in place of a clone of the formula, after copying its parameters.
+ */
+bool ParametricModel::isSameFunction(const TF1 *clone, const TF1 *formula)
+{
+  if(clone->GetNpar() != formula->GetNpar() || clone->GetNdim() != formula->GetNdim()) return false;
+  if(clone->GetXmin() != formula->GetXmin() || clone->GetXmax() != formula->GetXmax()) return false;
+  TString expression = formula->GetExpFormula();
+  return expression.Length() > 0 && expression == clone->GetExpFormula();
+}
+
+/**
+ * If this model is a view, the parameters of this model are first copied to the shared formula:
+ * the returned formula is only guaranteed to describe this model until the formula of
+ * another view is requested.
+ *
  * @return a pointer to the <a href="https://root.cern.ch/doc/v610/classTF1.html">TF1</a> 
  * formula for this model.
  */
 TF1 *ParametricModel::getFormula()
 {
+  if(m_parameters) m_formula->SetParameters(m_parameters);
   return m_formula;
 }
 
 
 /**
+ * See the non-const version for the case where this model is a view.
+ *
  * @return a const pointer to the <a href="https://root.cern.ch/doc/v610/classTF1.html">TF1</a> 
  * formula for this model.
  */
 const TF1 *ParametricModel::getFormula() const
 {
+  if(m_parameters) m_formula->SetParameters(m_parameters);
   return m_formula;
 }
 
+/**
+ * @return Number of parameters of the formula.
+ */
+int ParametricModel::getNpar() const
+{
+  return m_formula->GetNpar();
+}
+
+/**
+ * @param p Index of the parameter.
+ * @return Value of the parameter.
+ */
+double ParametricModel::getParameter(int p) const
+{
+  if(m_parameters) return m_parameters[p];
+  return m_formula->GetParameter(p);
+}
+
+/**
+ * @param p Index of the parameter.
+ * @param value Value of the parameter.
+ */
+void ParametricModel::setParameter(int p, double value)
+{
+  if(m_parameters) m_parameters[p] = value;
+  else m_formula->SetParameter(p, value);
+}
+
+/**
+ * @return Array of getNpar() parameter values.
+ */
+const double *ParametricModel::getParameters() const
+{
+  if(m_parameters) return m_parameters;
+  return m_formula->GetParameters();
+}
+
+/**
+ * @param values Array of getNpar() parameter values.
+ */
+void ParametricModel::setParameters(const double *values)
+{
+  if(m_parameters) {
+    for(int p=0; p<getNpar(); p++) m_parameters[p] = values[p];
+  }else{
+    m_formula->SetParameters(values);
+  }
+}
+
+/**
+ * The genome of a parametric model consists of its parameters.
+ *
+ * @return Number of parameters of the formula.
+ */
+int ParametricModel::getGenomeSize() const
+{
+  return getNpar();
+}
+
+/**
+ * @return Array of getNpar() parameter values.
+ */
+const double *ParametricModel::getGenome() const
+{
+  return getParameters();
+}
 
-			     
+/**
+ * @param genome Array of getNpar() parameter values.
+ */
+void ParametricModel::setGenome(const double *genome)
+{
+  setParameters(genome);
+  setDirty();
+}
+
+/**
+ * The parameters of this model are passed explicitly to the formula, which is left unmodified.
+ * Derived classes may reimplement this method to evaluate the function without the formula.
+ *
+ * @param x Coordinates of the point.
+ * @return Value of the function at the given point.
+ */
+double ParametricModel::eval(const double *x) const
+{
+  return m_formula->EvalPar(x, getParameters());
+}
+
+/**
+ * The coordinates are given as one array per dimension, such that the i-th point is
+ * \f$(x[0][i], ..., x[ndim-1][i])\f$.
+ *
+ * The default implementation evaluates the formula point by point. Derived classes able to evaluate
+ * the function in bulk should reimplement this method.
+ *
+ * @param n Number of points.
+ * @param ndim Number of dimensions of the points (at most kMaxDimensions).
+ * @param x Array of ndim arrays of n coordinates.
+ * @param fx Array of n values to be filled with the values of the function.
+ */
+void ParametricModel::evalBatch(int n, int ndim, const double *const *x, double *fx) const
+{
+  const double *params = getParameters();
+  if(ndim == 1) {
+    const double *x0 = x[0];
+    for(int i=0; i<n; i++) {
+      fx[i] = m_formula->EvalPar(x0+i, params);
+    }
+  }else{
+    double point[kMaxDimensions];
+    for(int i=0; i<n; i++) {
+      for(int d=0; d<ndim; d++) point[d] = x[d][i];
+      fx[i] = m_formula->EvalPar(point, params);
+    }
+  }
+}
@@ -2,15 +2,23 @@
 
 #include "ParametricModel.h"
 
+#include <stdexcept>
+
 ParametricModelPopulation::ParametricModelPopulation() :
   IPopulation()
 {
   m_formula = 0;
   m_mutationSize = 0.1;
+  m_storage = kFormulaClones;
+  m_sharedFormula = 0;
+  m_npar = 0;
 }
 
 ParametricModelPopulation::~ParametricModelPopulation()
 {
+  // Views refer to the shared formula and genes: release them first. They are reset before being recycled.
+  clear();
+  delete m_sharedFormula;
 }
 
 /**
@@ -29,74 +37,151 @@ void ParametricModelPopulation::setMutationSize(double relativeSize)
   m_mutationSize = relativeSize;
 }
 
+/**
+ * The storage mode takes effect at the next initialization.
+ *
+ * @param storage The storage mode for the parameters of the individuals.
+ */
+void ParametricModelPopulation::setGenomeStorage(GenomeStorage storage)
+{
+  m_storage = storage;
+}
+
 /**
  * Parameters for the individual models are randomly initialized following uniform 
  * distribution in the allowed range as defined in the population's formula.
+ * Each individual uses its own random stream.
+ *
+ * In kFlatBuffer mode, re-initializing a population of the same size with a formula describing the same function
+ * (see ParametricModel::isSameFunction()) reuses the models, the shared formula and the gene buffers, such that
+ * no memory is allocated. This allows a population to be recycled across many fits (see BatchFitter), even when
+ * each fit creates its own formula. The shared formula is also kept when the size changes, as long as the function
+ * is the same.
+ *
+ * Otherwise, the models are given back to the model pool and taken from it again (see IPopulation::acquireModel()):
+ * recycled models keep their clone of the formula if it describes the same function, such that
+ * re-initializing a population only resets the genes.
  *
  * @param The desired size of the population.
  */
 void ParametricModelPopulation::doInitialize(int n)
 {
-  clear();
+  bool sameFunction = m_sharedFormula && ParametricModel::isSameFunction(m_sharedFormula, m_formula);
+  bool reuse = m_storage == kFlatBuffer && sameFunction && size() == n && m_npar == m_formula->GetNpar();
+  if(!reuse) clear();
+
+  m_npar = m_formula->GetNpar();
+  m_parMin.resize(m_npar);
+  m_parMax.resize(m_npar);
+  for(int p=0; p<m_npar; p++) {
+    m_formula->GetParLimits(p, m_parMin[p], m_parMax[p]);
+  }
+  
+  if(m_storage == kFlatBuffer) {
+    if(!sameFunction) {
+      delete m_sharedFormula;
+      m_sharedFormula = (TF1*)m_formula->Clone();
+    }
+    m_genes.resize(n*m_npar);
+    m_offspringGenes.resize(n*m_npar);
+  }else{
+    delete m_sharedFormula;
+    m_sharedFormula = 0;
+    m_genes.clear();
+    m_offspringGenes.resize(n*m_npar);
+  }
+
+  if(!reuse) m_individuals.reserve(n);
   for(int i=0; i<n; i++) {
-    ParametricModel *model = new ParametricModel();
-    model->setFormula(m_formula);
-    TF1 *formula = model->getFormula();
-    for(int p=0; p<formula->GetNpar(); p++) {
-      double pmin, pmax;
-      formula->GetParLimits(p, pmin, pmax);
-      if(pmin < pmax) {
-	double par = m_random->Uniform(pmin, pmax);
-	formula->SetParameter(p, par);
+    ParametricModel *model = 0;
+    if(reuse) {
+      model = static_cast<ParametricModel*>(m_individuals[i]);
+    }else{
+      model = static_cast<ParametricModel*>(acquireModel());
+      if(!model) model = createModel();
+    }
+    if(m_storage == kFlatBuffer) {
+      model->setView(m_sharedFormula, &m_genes[i*m_npar]);
+      model->setParameters(m_formula->GetParameters());
+    }else{
+      model->setFormula(m_formula);
+    }
+    RandomStream random = getRandomStream(i, RandomStream::kInitialize);
+    for(int p=0; p<m_npar; p++) {
+      if(m_parMin[p] < m_parMax[p]) {
+	double par = random.Uniform(m_parMin[p], m_parMax[p]);
+	model->setParameter(p, par);
       }
     }
-    m_individuals.push_back(model);
+    if(!reuse) m_individuals.push_back(model);
   }
 }
 
 /**
  * Cross-over is implemented such that each parameter is passed from either parents chosen at random. 
+ * Each offspring uses its own random stream.
+ *
+ * Offspring identical to one of their parents are reported in m_copies, such that they are not re-evaluated.
+ *
+ * The genes of the offspring are written to the offspring buffer, since the parents are
+ * members of this population: the current generation is only read, such that disjoint ranges
+ * of offspring can be produced concurrently.
  *
- * @param parents List of parents to be crossed-over.
+ * @param parents Indices of the two parents of each offspring (see IPopulation::crossOver()).
+ * @param begin Index of the first offspring to be produced.
+ * @param end Index after the last offspring to be produced.
  */
-void ParametricModelPopulation::doCrossOver(const std::vector<std::vector<IModel*> > &parents)
+void ParametricModelPopulation::doCrossOver(const std::vector<int> &parents, int begin, int end)
 {
   
-  std::vector<std::vector<double> > offspringGenes;
-  for(int i=0; i<size(); i++) {
-    std::vector<double> offspring;
-    if(parents[i].size()==1) {
-      ParametricModel *parent = dynamic_cast<ParametricModel*>(parents[i][0]);
-      if(!parent) {
-	throw std::runtime_error("Given models are not parametric models");
-      }
-      TF1 *formula = parent->getFormula();
-      for(int p=0; p<formula->GetNpar(); p++) {
-	offspring.push_back(formula->GetParameter(p));
-      }
-    }else if(parents[i].size() == 2) {
-      ParametricModel *parent1 = dynamic_cast<ParametricModel*>(parents[i][0]);
-      ParametricModel *parent2 = dynamic_cast<ParametricModel*>(parents[i][1]);
-      if(!parent1 || !parent2) {
-	throw std::runtime_error("Given models are not parametric models");
+  for(int i=begin; i<end; i++) {
+    double *offspring = &m_offspringGenes[i*m_npar];
+    ParametricModel *parent1 = dynamic_cast<ParametricModel*>(m_individuals[parents[2*i]]);
+    ParametricModel *parent2 = parents[2*i+1] < 0 ? parent1 : dynamic_cast<ParametricModel*>(m_individuals[parents[2*i+1]]);
+    if(!parent1 || !parent2) {
+      throw std::runtime_error("Given models are not parametric models");
+    }
+    const double *genes1 = parent1->getParameters();
+    if(parent2 == parent1) {
+      for(int p=0; p<m_npar; p++) {
+	offspring[p] = genes1[p];
       }
-      TF1 *formula1 = parent1->getFormula();
-      TF1 *formula2 = parent2->getFormula();
-      for(int p=0; p<formula1->GetNpar(); p++) {
-	if(m_random->Integer(2)) {
-	  offspring.push_back(formula1->GetParameter(p));
-	}else{
-	  offspring.push_back(formula2->GetParameter(p));
-	}
+      m_copies[i] = parents[2*i];
+    }else{
+      const double *genes2 = parent2->getParameters();
+      RandomStream random = getRandomStream(i, RandomStream::kCrossOver);
+      bool same1 = true;
+      bool same2 = true;
+      for(int p=0; p<m_npar; p++) {
+	offspring[p] = random.Integer(2) ? genes1[p] : genes2[p];
+	same1 = same1 && offspring[p] == genes1[p];
+	same2 = same2 && offspring[p] == genes2[p];
       }
+      if(same1) m_copies[i] = parents[2*i];
+      else if(same2) m_copies[i] = parents[2*i+1];
     }
-    offspringGenes.push_back(offspring);
   }
+}
 
-  for(int i=0; i<size(); i++) {
-    ParametricModel *model = (ParametricModel*)m_individuals[i];
-    for(unsigned int p=0; p<offspringGenes[i].size(); p++) {
-      model->getFormula()->SetParameter(p, offspringGenes[i][p]);
+/**
+ * When the whole generation is replaced in kFlatBuffer mode, the two gene buffers are swapped and the views
+ * moved to the new generation. Otherwise, the offspring genes are copied to the models.
+ *
+ * @param begin Index of the first individual to be replaced.
+ * @param end Index after the last individual to be replaced.
+ */
+void ParametricModelPopulation::doReplaceParents(int begin, int end)
+{
+  if(m_storage == kFlatBuffer && begin == 0 && end == size()) {
+    m_genes.swap(m_offspringGenes);
+    for(int i=0; i<size(); i++) {
+      ParametricModel *model = (ParametricModel*)m_individuals[i];
+      model->setView(m_sharedFormula, &m_genes[i*m_npar]);
+    }
+  }else{
+    for(int i=begin; i<end; i++) {
+      ParametricModel *model = (ParametricModel*)m_individuals[i];
+      model->setParameters(&m_offspringGenes[i*m_npar]);
     }
   }
 }
@@ -106,8 +191,9 @@ void ParametricModelPopulation::doCrossOver(const std::vector<std::vector<IModel
  * The size of the gaussian noise is controlled via setMutationSize().
  *
  * @param imodel Model to be mutated.
+ * @param random Random stream of the model.
  */
-void ParametricModelPopulation::doMutate(IModel *imodel)
+void ParametricModelPopulation::doMutate(IModel *imodel, RandomStream &random)
 {
   
   ParametricModel *model = dynamic_cast<ParametricModel*>(imodel);
@@ -115,14 +201,31 @@ void ParametricModelPopulation::doMutate(IModel *imodel)
     throw std::runtime_error("Given models are not parametric models");
   }
 
-  TF1 *formula = model->getFormula();
-  int p = m_random->Integer(formula->GetNpar());
-  double pmin, pmax;
-  formula->GetParLimits(p, pmin, pmax);
-  if(pmin < pmax) {
-    double par = formula->GetParameter(p);
-    par += m_random->Gaus(0, par==0?m_mutationSize:par*m_mutationSize);
-    formula->SetParameter(p, par);
+  int p = random.Integer(m_npar);
+  if(m_parMin[p] < m_parMax[p]) {
+    double par = model->getParameter(p);
+    par += random.Gaus(0, par==0?m_mutationSize:par*m_mutationSize);
+    model->setParameter(p, par);
   }
 }
 
+/**
+ * Cross-over only reads the current generation and writes to the offspring buffer,
+ * and mutation only modifies the given model.
+ *
+ * @return true
+ */
+bool ParametricModelPopulation::isBreedingThreadSafe() const
+{
+  return true;
+}
+
+/**
+ * Derived classes can reimplement this method to populate with a specialized model.
+ *
+ * @return A new model, owned by the caller.
+ */
+ParametricModel *ParametricModelPopulation::createModel()
+{
+  return new ParametricModel();
+}
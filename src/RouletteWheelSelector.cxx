@@ -0,0 +1,97 @@
+#include "RouletteWheelSelector.h"
+
+const int RouletteWheelSelector::kMaxRetries;
+
+RouletteWheelSelector::RouletteWheelSelector() :
+  IParentSelector()
+{
+}
+
+RouletteWheelSelector::~RouletteWheelSelector()
+{
+}
+
+/**
+ * Uses Vose's construction of the alias table, in linear time.
+ *
+ * @param n Number of individuals eligible as parents.
+ * @param scores Array of the n scores of these individuals, from the best to the least fitted.
+ */
+void RouletteWheelSelector::prepare(int n, const double *scores)
+{
+  IParentSelector::prepare(n, scores);
+
+  double total = computeFitness(n, scores, m_weights);
+  m_probability.resize(n);
+  m_alias.resize(n);
+  m_small.clear();
+  m_large.clear();
+  for(int i=0; i<n; i++) {
+    m_weights[i] *= n/total;
+    m_alias[i] = i;
+    if(m_weights[i] < 1) m_small.push_back(i);
+    else m_large.push_back(i);
+  }
+
+  while(!m_small.empty() && !m_large.empty()) {
+    int s = m_small.back();
+    int l = m_large.back();
+    m_small.pop_back();
+    m_probability[s] = m_weights[s];
+    m_alias[s] = l;
+    m_weights[l] -= 1 - m_weights[s];
+    if(m_weights[l] < 1) {
+      m_large.pop_back();
+      m_small.push_back(l);
+    }
+  }
+
+  // Remaining columns are full, up to rounding errors
+  for(unsigned int i=0; i<m_small.size(); i++) {
+    m_probability[m_small[i]] = 1;
+  }
+  for(unsigned int i=0; i<m_large.size(); i++) {
+    m_probability[m_large[i]] = 1;
+  }
+}
+
+/**
+ * The second parent is drawn again while it is identical to the first one, up to kMaxRetries times.
+ * This only happens if the first parent dominates the fitness of the population, in which case
+ * the second parent is drawn uniformly among the other individuals.
+ *
+ * @param nPairs Number of offspring.
+ * @param parents Returns the 2*nPairs parent ranks, the parents of the i-th offspring being at positions 2i and 2i+1.
+ * @param random Random number generator.
+ */
+void RouletteWheelSelector::select(int nPairs, int *parents, RandomStream &random)
+{
+  int n = m_n;
+  if(n <= 1) {
+    for(int i=0; i<2*nPairs; i++) {
+      parents[i] = 0;
+    }
+    return;
+  }
+
+  for(int i=0; i<nPairs; i++) {
+    int p1 = draw(random);
+    int p2 = draw(random);
+    for(int retry=0; p2 == p1 && retry < kMaxRetries; retry++) {
+      p2 = draw(random);
+    }
+    if(p2 == p1) p2 = drawOther(p1, n, random);
+    parents[2*i] = p1;
+    parents[2*i+1] = p2;
+  }
+}
+
+/**
+ * @param random Random number generator.
+ * @return The rank of the selected individual.
+ */
+int RouletteWheelSelector::draw(RandomStream &random)
+{
+  int column = random.Integer(m_n);
+  return random.Rndm() < m_probability[column] ? column : m_alias[column];
+}
@@ -0,0 +1,31 @@
+#include "ScoreRMSTermination.h"
+#include "IPopulation.h"
+#include "IModel.h"
+
+#include <cmath>
+
+/**
+ * @param minRelativeRMS RMS of the scores, relative to the best score, below which the optimization stops.
+ */
+ScoreRMSTermination::ScoreRMSTermination(double minRelativeRMS) :
+  ITerminationPolicy()
+{
+  m_minRelativeRMS = minRelativeRMS;
+}
+
+ScoreRMSTermination::~ScoreRMSTermination()
+{
+}
+
+/**
+ * If the best score is 0, the optimization only stops once all scores are equal.
+ *
+ * @param population Population being optimized.
+ * @param generation Number of the last generation.
+ * @return `true` if the relative RMS of the scores is below the minimum.
+ */
+bool ScoreRMSTermination::shouldStop(IPopulation *population, int generation)
+{
+  double best = population->getBestFitted()->getScore();
+  return population->getScoreRMS() <= m_minRelativeRMS*std::fabs(best);
+}
@@ -0,0 +1,56 @@
+#include "StallTermination.h"
+#include "IPopulation.h"
+#include "IModel.h"
+#include "IFigureOfMerit.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <cmath>
+
+/**
+ * @param nGenerations Number of generations without improvement before stopping, at least 1.
+ * @param tolerance Improvements of the best score smaller than this fraction of its value are ignored.
+ */
+StallTermination::StallTermination(int nGenerations, double tolerance) :
+  ITerminationPolicy()
+{
+  if(nGenerations < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of generations (" << nGenerations << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_nGenerations = nGenerations;
+  m_tolerance = tolerance;
+  m_bestScore = 0;
+  m_lastImprovement = 0;
+}
+
+StallTermination::~StallTermination()
+{
+}
+
+/**
+ * @param population Population being optimized, initialized and scored.
+ * @param generation Number of the generation the optimization starts from, 0 unless resuming.
+ */
+void StallTermination::reset(IPopulation *population, int generation)
+{
+  m_bestScore = population->getBestFitted()->getScore();
+  m_lastImprovement = generation;
+}
+
+/**
+ * @param population Population being optimized.
+ * @param generation Number of the last generation.
+ * @return `true` if the best score has not improved over the last generations.
+ */
+bool StallTermination::shouldStop(IPopulation *population, int generation)
+{
+  double best = population->getBestFitted()->getScore();
+  if(population->getFigureOfMerit()->isBetterThan(best, m_bestScore)
+     && std::fabs(best - m_bestScore) > m_tolerance*std::fabs(m_bestScore)) {
+    m_bestScore = best;
+    m_lastImprovement = generation;
+  }
+  return generation - m_lastImprovement >= m_nGenerations;
+}
@@ -0,0 +1,97 @@
+#include "StatsLogger.h"
+#include "GenerationStats.h"
+
+#include <stdexcept>
+#include <sstream>
+
+StatsLogger::StatsLogger()
+{
+  m_format = kCSV;
+}
+
+StatsLogger::~StatsLogger()
+{
+  close();
+}
+
+/**
+ * Files ending with `.json` or `.jsonl` are written in the kJSON format, other files in the kCSV format.
+ *
+ * @param fileName Name of the file, which is overwritten.
+ */
+void StatsLogger::open(const std::string &fileName)
+{
+  std::string::size_type dot = fileName.rfind('.');
+  std::string extension = dot == std::string::npos ? "" : fileName.substr(dot);
+  open(fileName, extension == ".json" || extension == ".jsonl" ? kJSON : kCSV);
+}
+
+/**
+ * @param fileName Name of the file, which is overwritten.
+ * @param format Output format.
+ */
+void StatsLogger::open(const std::string &fileName, Format format)
+{
+  close();
+  m_file.open(fileName.c_str());
+  if(!m_file) {
+    std::ostringstream ostr;
+    ostr << "Cannot open statistics log " << fileName;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_format = format;
+  if(m_format == kCSV) {
+    m_file << "generation,totalTime,scoreTime,sortTime,selectionTime,crossOverTime,mutationTime,"
+	   << "nEvaluations,cacheHits,randomDraws,allocations" << std::endl;
+  }
+}
+
+void StatsLogger::close()
+{
+  if(m_file.is_open()) m_file.close();
+}
+
+/**
+ * @return `true` if a file is open.
+ */
+bool StatsLogger::isOpen() const
+{
+  return m_file.is_open();
+}
+
+/**
+ * Each generation is flushed to the file, such that it can be monitored during the optimization.
+ *
+ * @param stats Statistics of the generation.
+ */
+void StatsLogger::write(const GenerationStats &stats)
+{
+  if(!m_file.is_open()) return;
+
+  if(m_format == kCSV) {
+    m_file << stats.generation << ","
+	   << stats.totalTime << ","
+	   << stats.scoreTime << ","
+	   << stats.sortTime << ","
+	   << stats.selectionTime << ","
+	   << stats.crossOverTime << ","
+	   << stats.mutationTime << ","
+	   << stats.nEvaluations << ","
+	   << stats.cacheHits << ","
+	   << stats.randomDraws << ","
+	   << stats.allocations << std::endl;
+  }else{
+    m_file << "{\"generation\": " << stats.generation
+	   << ", \"totalTime\": " << stats.totalTime
+	   << ", \"scoreTime\": " << stats.scoreTime
+	   << ", \"sortTime\": " << stats.sortTime
+	   << ", \"selectionTime\": " << stats.selectionTime
+	   << ", \"crossOverTime\": " << stats.crossOverTime
+	   << ", \"mutationTime\": " << stats.mutationTime
+	   << ", \"nEvaluations\": " << stats.nEvaluations
+	   << ", \"cacheHits\": " << stats.cacheHits
+	   << ", \"randomDraws\": " << stats.randomDraws
+	   << ", \"allocations\": " << stats.allocations
+	   << "}" << std::endl;
+  }
+}
@@ -0,0 +1,78 @@
+#include "StochasticUniversalSelector.h"
+
+#include <algorithm>
+
+StochasticUniversalSelector::StochasticUniversalSelector() :
+  IParentSelector()
+{
+  m_total = 0;
+}
+
+StochasticUniversalSelector::~StochasticUniversalSelector()
+{
+}
+
+/**
+ * @param n Number of individuals eligible as parents.
+ * @param scores Array of the n scores of these individuals, from the best to the least fitted.
+ */
+void StochasticUniversalSelector::prepare(int n, const double *scores)
+{
+  IParentSelector::prepare(n, scores);
+
+  m_total = computeFitness(n, scores, m_weights);
+  for(int i=1; i<n; i++) {
+    m_weights[i] += m_weights[i-1];
+  }
+}
+
+/**
+ * After shuffling, pairs made of the same individual twice are fixed by exchanging their second parent
+ * with the second parent of another pair. If no such exchange is possible, which requires an individual to
+ * hold more than half of the total fitness, the second parent is drawn uniformly among the other individuals.
+ *
+ * @param nPairs Number of offspring.
+ * @param parents Returns the 2*nPairs parent ranks, the parents of the i-th offspring being at positions 2i and 2i+1.
+ * @param random Random number generator.
+ */
+void StochasticUniversalSelector::select(int nPairs, int *parents, RandomStream &random)
+{
+  int n = m_n;
+  int m = 2*nPairs;
+  if(n <= 1) {
+    for(int i=0; i<m; i++) {
+      parents[i] = 0;
+    }
+    return;
+  }
+  if(m == 0) return;
+
+  // Equally spaced pointers
+  double spacing = m_total/m;
+  double pointer = random.Rndm()*spacing;
+  int k = 0;
+  for(int i=0; i<m; i++, pointer += spacing) {
+    while(k < n-1 && m_weights[k] <= pointer) k++;
+    parents[i] = k;
+  }
+
+  // Fisher-Yates shuffle
+  for(int i=m-1; i>0; i--) {
+    int j = random.Integer(i+1);
+    std::swap(parents[i], parents[j]);
+  }
+
+  for(int i=0; i<nPairs; i++) {
+    int p = parents[2*i];
+    if(parents[2*i+1] != p) continue;
+    bool fixed = false;
+    for(int j=1; j<nPairs && !fixed; j++) {
+      int other = (i+j)%nPairs;
+      if(parents[2*other] != p && parents[2*other+1] != p) {
+	std::swap(parents[2*i+1], parents[2*other+1]);
+	fixed = true;
+      }
+    }
+    if(!fixed) parents[2*i+1] = drawOther(p, n, random);
+  }
+}
@@ -0,0 +1,144 @@
+#include "ThreadPool.h"
+
+#include <TROOT.h>
+
+#include <stdexcept>
+#include <sstream>
+
+/**
+ * The tasks of the pool may run ROOT code, e.g. formulas compiled lazily on their first evaluation:
+ * ROOT's thread-safety is enabled before the workers are started, if there are any.
+ *
+ * @param nThreads Number of threads processing a loop, including the calling thread.
+ */
+ThreadPool::ThreadPool(int nThreads)
+{
+  if(nThreads < 1) {
+    std::ostringstream ostr;
+    ostr << "Number of threads (" << nThreads << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  m_task = 0;
+  m_n = 0;
+  m_chunkSize = 1;
+  m_next = 0;
+  m_busy = 0;
+  m_loop = 0;
+  m_stop = false;
+
+  if(nThreads > 1) ROOT::EnableThreadSafety();
+  for(int i=1; i<nThreads; i++) {
+    m_workers.push_back(std::thread(&ThreadPool::work, this));
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  for(unsigned int i=0; i<m_workers.size(); i++) {
+    m_workers[i].join();
+  }
+}
+
+/**
+ * @return Number of threads processing a loop, including the calling thread.
+ */
+int ThreadPool::getNThreads() const
+{
+  return m_workers.size() + 1;
+}
+
+/**
+ * This function is not reentrant: it should not be called concurrently, nor from within a task.
+ *
+ * @param n Size of the range to be processed.
+ * @param chunkSize Number of consecutive indices per chunk. If 0 or less, the range is split
+ * into about four chunks per thread.
+ * @param task Function called as `task(begin, end)` for each chunk \f$[begin, end[\f$.
+ */
+void ThreadPool::parallelFor(int n, int chunkSize, const std::function<void(int, int)> &task)
+{
+  if(n <= 0) return;
+
+  if(chunkSize <= 0) {
+    chunkSize = n / (4*getNThreads());
+    if(chunkSize < 1) chunkSize = 1;
+  }
+
+  if(m_workers.empty() || chunkSize >= n) {
+    task(0, n);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_n = n;
+    m_chunkSize = chunkSize;
+    m_next = 0;
+    m_busy = m_workers.size();
+    m_error = std::exception_ptr();
+    m_loop++;
+  }
+  m_wakeUp.notify_all();
+
+  runChunks();
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_busy > 0) m_finished.wait(lock);
+    m_task = 0;
+    error = m_error;
+  }
+
+  if(error) std::rethrow_exception(error);
+}
+
+void ThreadPool::work()
+{
+  unsigned int loop = 0;
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while(!m_stop && m_loop == loop) m_wakeUp.wait(lock);
+      if(m_stop) return;
+      loop = m_loop;
+    }
+
+    runChunks();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_busy--;
+    }
+    m_finished.notify_one();
+  }
+}
+
+void ThreadPool::runChunks()
+{
+  while(true) {
+    int begin;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(m_next >= m_n || m_error) return;
+      begin = m_next;
+      m_next += m_chunkSize;
+    }
+    int end = begin + m_chunkSize;
+    if(end > m_n) end = m_n;
+
+    try {
+      (*m_task)(begin, end);
+    }catch(...) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(!m_error) m_error = std::current_exception();
+    }
+  }
+}
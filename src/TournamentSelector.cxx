@@ -0,0 +1,65 @@
+#include "TournamentSelector.h"
+
+#include <stdexcept>
+#include <sstream>
+
+/**
+ * @param tournamentSize Number of individuals competing for each selection.
+ */
+TournamentSelector::TournamentSelector(int tournamentSize) :
+  IParentSelector()
+{
+  setTournamentSize(tournamentSize);
+}
+
+TournamentSelector::~TournamentSelector()
+{
+}
+
+/**
+ * Competitors are drawn uniformly, with replacement. Since individuals are ranked,
+ * the winner is the competitor with the lowest rank. The competitors for the second parent
+ * are drawn excluding the first parent.
+ *
+ * @param nPairs Number of offspring.
+ * @param parents Returns the 2*nPairs parent ranks, the parents of the i-th offspring being at positions 2i and 2i+1.
+ * @param random Random number generator.
+ */
+void TournamentSelector::select(int nPairs, int *parents, RandomStream &random)
+{
+  int n = m_n;
+  if(n <= 1) {
+    for(int i=0; i<2*nPairs; i++) {
+      parents[i] = 0;
+    }
+    return;
+  }
+
+  for(int i=0; i<nPairs; i++) {
+    int p1 = n;
+    for(int k=0; k<m_tournamentSize; k++) {
+      int p = random.Integer(n);
+      if(p < p1) p1 = p;
+    }
+    int p2 = n;
+    for(int k=0; k<m_tournamentSize; k++) {
+      int p = drawOther(p1, n, random);
+      if(p < p2) p2 = p;
+    }
+    parents[2*i] = p1;
+    parents[2*i+1] = p2;
+  }
+}
+
+/**
+ * @param tournamentSize Number of individuals competing for each selection, at least 1.
+ */
+void TournamentSelector::setTournamentSize(int tournamentSize)
+{
+  if(tournamentSize < 1) {
+    std::ostringstream ostr;
+    ostr << "Tournament size (" << tournamentSize << ") should be at least 1";
+    throw std::runtime_error(ostr.str().c_str());
+  }
+  m_tournamentSize = tournamentSize;
+}
@@ -0,0 +1,136 @@
+#include "TraceWriter.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <utility>
+
+const int TraceWriter::kBlockSize;
+
+TraceWriter::TraceWriter()
+{
+  m_npar = 0;
+  m_ready = false;
+  m_busy = false;
+  m_stop = false;
+}
+
+TraceWriter::~TraceWriter()
+{
+  close();
+}
+
+/**
+ * @param path Path of the trace file, which is overwritten.
+ * @param npar Number of parameters of the best fitted individual recorded for each generation.
+ */
+void TraceWriter::open(const std::string &path, int npar)
+{
+  close();
+  m_file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+  if(!m_file) {
+    std::ostringstream ostr;
+    ostr << "Cannot open trace " << path;
+    throw std::runtime_error(ostr.str().c_str());
+  }
+
+  m_npar = npar;
+  m_recording.setNPar(npar);
+  m_writing.setNPar(npar);
+  m_recording.writeHeader(m_file);
+  m_file.flush();
+
+  m_ready = false;
+  m_busy = false;
+  m_stop = false;
+  m_thread = std::thread(&TraceWriter::run, this);
+}
+
+void TraceWriter::close()
+{
+  if(!m_file.is_open()) return;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready = m_recording.size() > 0;
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  m_thread.join();
+  m_file.close();
+}
+
+/**
+ * @return `true` if a file is open.
+ */
+bool TraceWriter::isOpen() const
+{
+  return m_file.is_open();
+}
+
+/**
+ * @return Number of parameters per row.
+ */
+int TraceWriter::getNPar() const
+{
+  return m_npar;
+}
+
+/**
+ * Nothing is recorded if no file is open.
+ *
+ * @param generation Generation number.
+ * @param best Score of the best fitted individual.
+ * @param mean Mean of the scores.
+ * @param rms RMS of the scores.
+ * @param parameters Array of getNPar() parameters of the best fitted individual.
+ */
+void TraceWriter::record(int generation, double best, double mean, double rms, const double *parameters)
+{
+  if(!m_file.is_open()) return;
+
+  bool ready;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording.append(generation, best, mean, rms, parameters);
+    ready = m_recording.size() >= kBlockSize;
+    if(ready) m_ready = true;
+  }
+  if(ready) m_wakeUp.notify_all();
+}
+
+/**
+ * The rows recorded so far are written as a block, even if it holds less than kBlockSize rows.
+ */
+void TraceWriter::flush()
+{
+  if(!m_file.is_open()) return;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if(m_recording.size() > 0) {
+    m_ready = true;
+    m_wakeUp.notify_all();
+  }
+  m_done.wait(lock, [this]() { return !m_ready && !m_busy; });
+}
+
+void TraceWriter::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(true) {
+    m_wakeUp.wait(lock, [this]() { return m_ready || m_stop; });
+    if(!m_ready) break;
+
+    std::swap(m_recording, m_writing);
+    m_ready = false;
+    m_busy = true;
+    lock.unlock();
+
+    m_writing.writeBlock(m_file);
+    m_file.flush();
+    m_writing.clear();
+
+    lock.lock();
+    m_busy = false;
+    m_done.notify_all();
+  }
+}
@@ -0,0 +1,34 @@
+#include "WallClockTermination.h"
+
+/**
+ * @param maxSeconds Time budget in seconds.
+ */
+WallClockTermination::WallClockTermination(double maxSeconds) :
+  ITerminationPolicy()
+{
+  m_maxSeconds = maxSeconds;
+  m_start = std::chrono::steady_clock::now();
+}
+
+WallClockTermination::~WallClockTermination()
+{
+}
+
+/**
+ * @param population Population being optimized, initialized and scored.
+ * @param generation Number of the generation the optimization starts from, 0 unless resuming.
+ */
+void WallClockTermination::reset(IPopulation *population, int generation)
+{
+  m_start = std::chrono::steady_clock::now();
+}
+
+/**
+ * @param population Population being optimized.
+ * @param generation Number of the last generation.
+ * @return `true` if the time budget is spent.
+ */
+bool WallClockTermination::shouldStop(IPopulation *population, int generation)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() >= m_maxSeconds;
+}
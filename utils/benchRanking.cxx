@@ -0,0 +1,181 @@
+/**
+ * @file
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "IModel.h"
+#include "IPopulation.h"
+#include "Chi2FitFigureOfMerit.h"
+#include "optparse.h"
+
+void parseCommandLine(Config &config, int argc, char **argv);
+
+/**
+ * @defgroup benchRanking Ranking Benchmark
+ *
+ * @brief Benchmark of the population ranking.
+ *
+ * @b Objective: Compare the cost of ranking a population using the legacy bubble sort,
+ * the full \f$O(n\log n)\f$ ranking and the partial ranking used when a selection window is set,
+ * for populations of 1k, 10k and 100k individuals.
+ *
+ * @{
+ */
+
+/**
+ * @brief Minimal model holding only a score.
+ */
+class BenchModel : public IModel {
+};
+
+/**
+ * @brief Population of models with random scores exposing the ranking stages.
+ */
+class BenchPopulation : public IPopulation {
+
+public:
+
+  /** Shuffles the scores of all individuals, invalidating the ranking. */
+  void shuffle() {
+    m_generation++;
+    RandomStream random = getRandomStream(0, RandomStream::kUser);
+    for(int i=0; i<size(); i++) {
+      m_individuals[i]->setScore(random.Uniform(0, 1000));
+    }
+    m_nRanked = 0;
+  }
+
+  /** Ranks the given number of best fitted individuals (0 for all). */
+  void rank(int nBest) {
+    sort(nBest);
+  }
+
+  /** Ranks all individuals using the legacy bubble sort. */
+  void bubbleSort() {
+    int n = size();
+    while (n > 0) {
+      int newn = 0;
+      for (int i = 1; i<=n-1; i++) {
+	if ( m_fom->isBetterThan(m_individuals[i], m_individuals[i-1]) ) {
+	  IModel *temp = m_individuals[i];
+	  m_individuals[i] = m_individuals[i-1];
+	  m_individuals[i-1] = temp;
+	  newn = i;
+	}
+      }
+      n = newn;
+    }
+  }
+
+protected:
+
+  void doInitialize(int n) {
+    clear();
+    for(int i=0; i<n; i++) {
+      m_individuals.push_back(new BenchModel());
+    }
+  }
+
+  void doCrossOver(const std::vector<int> &, int, int) {}
+
+  void doReplaceParents(int, int) {}
+
+  void doMutate(IModel *, RandomStream &) {}
+};
+
+/**
+ * @brief Main function
+ *
+ * For each population size, the scores are randomly shuffled before each ranking and the average
+ * time per ranking is reported for each of the three methods.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return 0 upon successfull exit
+ */
+int main(int argc, char **argv) {
+
+  Config config;
+  parseCommandLine(config, argc, argv);
+
+  int nRepeat = config.get("nRepeat");
+  double windowFraction = config.get("window");
+  int maxBubble = config.get("maxBubble");
+
+  Chi2FitFigureOfMerit fom;
+
+  std::cout << std::setw(10) << "size"
+	    << std::setw(16) << "bubble [ms]"
+	    << std::setw(16) << "full [ms]"
+	    << std::setw(16) << "partial [ms]" << std::endl;
+
+  int sizes[] = {1000, 10000, 100000};
+  for(int s=0; s<3; s++) {
+    int n = sizes[s];
+    int window = (int)(n*windowFraction);
+
+    BenchPopulation population;
+    population.setFigureOfMerit(&fom);
+    population.initialize(n);
+
+    double time[3] = {-1, -1, -1};
+    for(int method=0; method<3; method++) {
+      if(method == 0 && n > maxBubble) continue;
+      double total = 0;
+      for(int r=0; r<nRepeat; r++) {
+	population.shuffle();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if(method == 0) population.bubbleSort();
+	else if(method == 1) population.rank(0);
+	else population.rank(window);
+	std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	total += std::chrono::duration<double, std::milli>(stop-start).count();
+      }
+      time[method] = total/nRepeat;
+    }
+
+    std::cout << std::setw(10) << n;
+    for(int method=0; method<3; method++) {
+      std::cout << std::setw(16);
+      if(time[method] < 0) std::cout << "skipped";
+      else std::cout << time[method];
+    }
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Prase command line arguments.
+ *
+ * @param config Configuration to parse into.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ *
+ * #### Configuration details:
+ */
+void parseCommandLine(Config &config, int argc, char **argv)
+{
+
+  optparse::OptionParser parser = optparse::OptionParser().description("Ranking Benchmark");
+
+  /** - @b -r, <b> \-\-nRepeat </b> Number of rankings averaged for each measurement. */
+  parser.add_option("-r", "--nRepeat").action("store").dest("nRepeat").set_default(10)
+    .help("Number of rankings averaged for each measurement.");
+
+  /** - @b -w, <b> \-\-window </b> Selection window used for the partial ranking, as a fraction of the population size. */
+  parser.add_option("-w", "--window").action("store").dest("window").set_default(0.1)
+    .help("Selection window used for the partial ranking, as a fraction of the population size.");
+
+  /** - @b -b, <b> \-\-maxBubble </b> Largest population size for which the legacy bubble sort is measured. */
+  parser.add_option("-b", "--maxBubble").action("store").dest("maxBubble").set_default(10000)
+    .help("Largest population size for which the legacy bubble sort is measured.");
+
+  config = parser.parse_args(argc, argv);
+}
+
+/** @} */
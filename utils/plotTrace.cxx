@@ -0,0 +1,188 @@
+/**
+ * @file
+ */
+
+#include <iostream>
+#include <string>
+
+#include "GenerationTrace.h"
+#include "optparse.h"
+
+#include <TH1.h>
+#include <TF1.h>
+#include <TFile.h>
+#include <TCanvas.h>
+#include <TGraph.h>
+#include <TSystem.h>
+#include <TStyle.h>
+#include <TLatex.h>
+#include <TString.h>
+#include <TLegend.h>
+
+void parseCommandLine(Config &config, int argc, char **argv);
+
+/**
+ * @defgroup plotTrace Trace Rendering
+ *
+ * @brief Offline rendering of the progress of an optimization.
+ *
+ * @b Objective: Draw the plots of the tests of runGA from the trace written during the optimization
+ * (see TraceWriter), such that the optimization itself does not spend its time drawing.
+ *
+ * @{
+ */
+
+/**
+ * @brief Main function
+ *
+ * This program performs the following tasks:
+ * - Reads the trace file.
+ * - Plots the best score and the relative RMS of the scores as function of the generation.
+ * - If the data file written by runGA is given, draws an animation of the best fitted model
+ * over the data, with at most a given number of frames.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return 0 upon successfull exit
+ */
+int main(int argc, char **argv) {
+
+  Config config;
+  parseCommandLine(config, argc, argv);
+
+  std::string traceFile = config.get("trace");
+  std::string dataFile = config.get("data");
+  std::string output = config.get("output");
+  int maxFrames = config.get("maxFrames");
+
+  GenerationTrace trace;
+  trace.read(traceFile);
+  std::cout << "Read " << trace.size() << " generations from " << traceFile << std::endl;
+  if(trace.size() == 0) return 0;
+
+  gSystem->Exec(TString::Format("mkdir -p %s", output.c_str()));
+  gStyle->SetOptStat(0); // disables stat box on plots
+
+  //
+  // Scores as function of the generation
+  //
+  TGraph *gScore = new TGraph(trace.size());
+  TGraph *gRMS = new TGraph(trace.size());
+  for(int i=0; i<trace.size(); i++) {
+    gScore->SetPoint(i, trace.generations[i], trace.bestScores[i]);
+    gRMS->SetPoint(i, trace.generations[i], trace.scoreRMS[i]/trace.bestScores[i]);
+  }
+
+  TCanvas *C_Score = new TCanvas("C_Score", "C_Score");
+  C_Score->cd()->SetLogx();
+  C_Score->cd()->SetLogy();
+  gScore->SetLineColor(4);
+  gScore->SetLineWidth(2);
+  gScore->Draw("AL");
+  C_Score->SaveAs((output + "/C_Score.png").c_str());
+  C_Score->SaveAs((output + "/C_Score.root").c_str());
+
+  TCanvas *C_RMS = new TCanvas("C_RMS", "C_RMS");
+  C_RMS->cd()->SetLogx();
+  C_RMS->cd()->SetLogy();
+  gRMS->SetLineColor(4);
+  gRMS->SetLineWidth(2);
+  gRMS->Draw("AL");
+  C_RMS->SaveAs((output + "/C_RMS.png").c_str());
+  C_RMS->SaveAs((output + "/C_RMS.root").c_str());
+
+  if(dataFile.empty()) return 0;
+
+  //
+  // Animation of the best fitted model over the data
+  //
+  TFile *file = TFile::Open(dataFile.c_str());
+  if(!file || file->IsZombie()) {
+    std::cerr << "Cannot open data file " << dataFile << std::endl;
+    return 1;
+  }
+  TH1 *hData = (TH1*)file->Get("hData");
+  TF1 *likelihoodFit = (TF1*)file->Get("likelihoodFit");
+  TF1 *f = (TF1*)file->Get("f");
+  if(!hData || !likelihoodFit || !f) {
+    std::cerr << "Data file " << dataFile << " does not hold hData, likelihoodFit and f" << std::endl;
+    return 1;
+  }
+  if(f->GetNpar() != trace.getNPar()) {
+    std::cerr << "Model has " << f->GetNpar() << " parameters, trace has " << trace.getNPar() << std::endl;
+    return 1;
+  }
+
+  double xmin = hData->GetXaxis()->GetXmin();
+  double xmax = hData->GetXaxis()->GetXmax();
+  hData->SetMarkerStyle(20);
+  likelihoodFit->SetLineColor(4);
+  likelihoodFit->SetLineStyle(7);
+  f->SetLineColor(2);
+  TLegend *L_anim = new TLegend(0.7, 0.7, 0.9, 0.9);
+  L_anim->AddEntry(hData, "Data", "lp");
+  L_anim->AddEntry(likelihoodFit, "Likelihood fit", "l");
+  L_anim->AddEntry(f, "GA fit", "l");
+  TLatex *lt_anim = new TLatex();
+  TCanvas *C_anim = new TCanvas("C_anim", "C_anim");
+  std::string animFile = output + "/C_anim.gif";
+  gSystem->Unlink(animFile.c_str());
+
+  int step = maxFrames > 0 && trace.size() > maxFrames ? (trace.size() + maxFrames - 1)/maxFrames : 1;
+  std::vector<double> parameters(trace.getNPar());
+  for(int i=0; i<trace.size(); i+=step) {
+    int row = i + step < trace.size() ? i : trace.size()-1;
+    for(int p=0; p<trace.getNPar(); p++) {
+      parameters[p] = trace.bestParameters[p][row];
+    }
+    f->SetParameters(parameters.data());
+    C_anim->cd();
+    hData->Draw();
+    likelihoodFit->Draw("same");
+    f->Draw("same");
+    L_anim->Draw();
+    lt_anim->SetText(xmin + (xmax-xmin)/10., hData->GetMaximum()*0.9, TString::Format("Generation: %d", trace.generations[row]));
+    lt_anim->Draw();
+    C_anim->Modified();
+    C_anim->Update();
+    C_anim->SaveAs((animFile + (row == trace.size()-1 ? "++300" : "+25")).c_str());
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Prase command line arguments.
+ *
+ * @param config Configuration to parse into.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ *
+ * #### Configuration details:
+ */
+void parseCommandLine(Config &config, int argc, char **argv)
+{
+
+  optparse::OptionParser parser = optparse::OptionParser().description("Trace Rendering");
+
+  /** - @b -i, <b> \-\-trace </b> Trace file written during the optimization. */
+  parser.add_option("-i", "--trace").action("store").dest("trace").set_default("figures/trace.gatrace")
+    .help("Trace file written during the optimization.");
+
+  /** - @b -d, <b> \-\-data </b> ROOT file holding the data (hData), the likelihood fit (likelihoodFit) and the model (f), as written by runGA (empty to skip the animation). */
+  parser.add_option("-d", "--data").action("store").dest("data").set_default("")
+    .help("ROOT file holding the data (hData), the likelihood fit (likelihoodFit) and the model (f), as written by runGA (empty to skip the animation).");
+
+  /** - @b -o, <b> \-\-output </b> Directory receiving the figures. */
+  parser.add_option("-o", "--output").action("store").dest("output").set_default("figures")
+    .help("Directory receiving the figures.");
+
+  /** - @b -f, <b> \-\-maxFrames </b> Maximum number of frames of the animation, sampled evenly over the generations (0 for all). */
+  parser.add_option("-f", "--maxFrames").action("store").dest("maxFrames").set_default(200)
+    .help("Maximum number of frames of the animation, sampled evenly over the generations (0 for all).");
+
+  config = parser.parse_args(argc, argv);
+}
+
+/** @} */
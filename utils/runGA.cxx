@@ -3,19 +3,35 @@
  */
 
 #include <iostream>
+#include <cmath>
 
 #include <TRandom3.h>
 
 #include "ParametricModel.h"
 #include "ParametricModelPopulation.h"
+#include "CompiledModelPopulation.h"
 #include "Chi2FitFigureOfMerit.h"
+#include "MultiProcessFigureOfMerit.h"
 #include "GeneticAlgorithm.h"
+#include "StaticGeneticAlgorithm.h"
+#include "CompiledChi2Fitness.h"
+#include "FigureOfMeritFitness.h"
+#include "StatsLogger.h"
+#include "Checkpoint.h"
+#include "CheckpointWriter.h"
+#include "TraceWriter.h"
+#include "CombinedTermination.h"
+#include "StallTermination.h"
+#include "DiversityTermination.h"
+#include "ScoreRMSTermination.h"
+#include "WallClockTermination.h"
+#include "EvaluationBudgetTermination.h"
 #include "optparse.h"
 
 #include <TH1.h>
 #include <TMath.h>
 #include <TCanvas.h>
-#include <TGraph.h>
+#include <TFile.h>
 #include <TSystem.h>
 #include <TStyle.h>
 #include <TLatex.h>
@@ -23,6 +39,21 @@
 #include <TLegend.h>
 
 void parseCommandLine(Config &config, int argc, char **argv);
+template<class Fitness> int fitStatic(Config &config, const Fitness *fitness, TF1 *f);
+
+/**
+ * @brief Compiled gaussian function, equivalent to ROOT's "gaus" formula.
+ */
+struct Gaussian {
+  static const int kNpar = 3; //!< Constant, Mean and Sigma.
+  static const int kNdim = 1; //!< Function of x only.
+  double operator()(const double *x, const double *p) const {
+    double t = (x[0]-p[1])/p[2];
+    return p[0]*exp(-0.5*t*t);
+  }
+};
+
+bool compareStaticScores(const CompiledChi2Fitness<Gaussian> *compiled, const FigureOfMeritFitness<CompiledChi2Fitness<Gaussian>::Genome> *interpreted, const TF1 *f);
 
 /**
  * @defgroup runGA Demo Program
@@ -42,8 +73,10 @@ void parseCommandLine(Config &config, int argc, char **argv);
  * - Generates a dataset following a gaussian distribution.
  * - Fits the generated distribution using ROOT's implementation.
  * - Fits the generated distribution using our GA implementation.
- *   - Perform some tests about the behavior of our GA algorithm.
- * - Plot the results of the main algorithm and the tests.
+ *   - With `--static`, uses the templated implementation instead (see fitStatic()), checks that the interpreted formula
+ *     and the compiled function give the same score to the best fitted parameters, and stops after printing the results.
+ *   - Records the progress of each generation for the tests, to be rendered offline by plotTrace.
+ * - Plot the results of the main algorithm.
  *
  * Full documentation of the algorithms is available in @ref index.
  * 
@@ -65,7 +98,22 @@ int main(int argc, char **argv) {
 	    << "  ==> mutateRate = " << (double)config.get("mutateRate") << std::endl
 	    << "  ==> mutateSize = " << (double)config.get("mutateSize") << std::endl
 	    << "  ==> maxGenerations = " << (int)config.get("maxGenerations") << std::endl
-	    << "  ==> populationSize = " << (int)config.get("populationSize") << std::endl;
+	    << "  ==> populationSize = " << (int)config.get("populationSize") << std::endl
+	    << "  ==> nThreads = " << (int)config.get("nThreads") << std::endl
+	    << "  ==> compiled = " << (bool)config.get("compiled") << std::endl
+	    << "  ==> static = " << (bool)config.get("static") << std::endl
+	    << "  ==> cacheSize = " << (int)config.get("cacheSize") << std::endl
+	    << "  ==> nProcesses = " << (int)config.get("nProcesses") << std::endl
+	    << "  ==> steadyState = " << (int)config.get("steadyState") << std::endl
+	    << "  ==> statsLog = " << (const char*)config.get("statsLog") << std::endl
+	    << "  ==> stallGenerations = " << (int)config.get("stallGenerations") << std::endl
+	    << "  ==> minDiversity = " << (double)config.get("minDiversity") << std::endl
+	    << "  ==> minRelativeRMS = " << (double)config.get("minRelativeRMS") << std::endl
+	    << "  ==> maxTime = " << (double)config.get("maxTime") << std::endl
+	    << "  ==> maxEvaluations = " << (long)config.get("maxEvaluations") << std::endl
+	    << "  ==> checkpoint = " << (const char*)config.get("checkpoint") << std::endl
+	    << "  ==> checkpointInterval = " << (int)config.get("checkpointInterval") << std::endl
+	    << "  ==> resume = " << (const char*)config.get("resume") << std::endl;
   
   //
   // Generates a dataset following a gaussian distribution.
@@ -77,7 +125,7 @@ int main(int argc, char **argv) {
   double xmin = mean-5*sigma;
   double xmax = mean+5*sigma;
   int nbins = 100;
-  TH1 *hData = new TH1F("hData", "", nbins, xmin, xmax);
+  TH1 *hData = new TH1D("hData", "", nbins, xmin, xmax);
   double dx = (xmax-xmin)/nbins;
   hData->Sumw2();
   hData->GetXaxis()->SetTitle("x");
@@ -97,19 +145,28 @@ int main(int argc, char **argv) {
   //
   Chi2FitFigureOfMerit fom;
   fom.setAcceptThreshold(config.get("acceptThreshold"));
-  std::vector<double> x(1);
-  for(int bin=1; bin<=hData->GetNbinsX(); bin++) {
-    x[0] = hData->GetBinCenter(bin);
-    fom.addData(x, hData->GetBinContent(bin), hData->GetBinError(bin));
-  }
+  fom.setData(hData);
 
   //
   // Configure the population to be optimized
   //
-  ParametricModelPopulation population;
-  population.setMutateRate(config.get("mutateRate"));
-  population.setMutationSize(config.get("mutateSize"));
-  population.setFigureOfMerit(&fom);
+  ParametricModelPopulation *population = 0;
+  if(config.get("compiled")) {
+    population = new CompiledModelPopulation<Gaussian>();
+  }else{
+    population = new ParametricModelPopulation();
+  }
+  population->setMutateRate(config.get("mutateRate"));
+  population->setMutationSize(config.get("mutateSize"));
+  population->setGenomeStorage(ParametricModelPopulation::kFlatBuffer);
+  population->setFitnessCacheSize(config.get("cacheSize"));
+  MultiProcessFigureOfMerit *mpFom = 0;
+  if((int)config.get("nProcesses") > 0) {
+    mpFom = new MultiProcessFigureOfMerit(&fom, config.get("nProcesses"));
+    population->setFigureOfMerit(mpFom);
+  }else{
+    population->setFigureOfMerit(&fom);
+  }
   TF1 *f = new TF1("f", "gaus", xmin, xmax);
   f->SetParameter(0, 1./(sigma*sqrt(2*TMath::Pi())));
   f->SetParameter(1, mean);
@@ -120,7 +177,18 @@ int main(int argc, char **argv) {
   f->SetParName(0, "Constant");
   f->SetParName(1, "Mean");
   f->SetParName(2, "Sigma");
-  population.setFormula(f);
+  population->setFormula(f);
+
+  //
+  // Fork the worker processes before any thread is started
+  //
+  if(mpFom) {
+    ParametricModel *prototype = config.get("compiled") ? new CompiledModel<Gaussian>() : new ParametricModel();
+    prototype->setFormula(f);
+    mpFom->startWorkers(prototype);
+    delete prototype;
+  }
+  population->setNThreads(config.get("nThreads"));
 
   std::cout << "Input parameters:" << std::endl;
   for(int i=0; i<f->GetNpar(); i++) {
@@ -131,12 +199,71 @@ int main(int argc, char **argv) {
 	      << std::endl;
   }
 
+  //
+  // Fit with the templated Genetic Algorithm instead if requested
+  //
+  if(config.get("static")) {
+    Chi2FitFigureOfMerit fom;
+    fom.setAcceptThreshold(config.get("acceptThreshold"));
+    fom.setData(hData);
+    CompiledChi2Fitness<Gaussian> compiledFitness;
+    compiledFitness.setAcceptThreshold(config.get("acceptThreshold"));
+    compiledFitness.setData(hData);
+    FigureOfMeritFitness<CompiledChi2Fitness<Gaussian>::Genome> interpretedFitness(&fom, f);
+    if(config.get("compiled")) fitStatic(config, &compiledFitness, f);
+    else fitStatic(config, &interpretedFitness, f);
+    bool sameScores = compareStaticScores(&compiledFitness, &interpretedFitness, f);
+    std::cout << "After GA fit: " << std::endl;
+    for(int i=0; i<f->GetNpar(); i++) {
+      std::cout << "  ==> " << f->GetParName(i) << " : " << f->GetParameter(i) << std::endl;
+    }
+    std::cout << "After Likelihood fit: " << std::endl;
+    for(int i=0; i<likelihoodFit->GetNpar(); i++) {
+      std::cout << "  ==> " << f->GetParName(i) << " : " << likelihoodFit->GetParameter(i) << std::endl;
+    }
+    return sameScores ? 0 : 1;
+  }
+
   //
   // Configure the Genetic Algorithm
   //
   GeneticAlgorithm alg;
   alg.setNGenerationsMax(config.get("maxGenerations"));
   alg.setPopulationSize(config.get("populationSize"));
+  alg.setSteadyState(config.get("steadyState"));
+  StatsLogger statsLogger;
+  std::string statsLog = config.get("statsLog");
+  if(!statsLog.empty()) {
+    statsLogger.open(statsLog);
+    alg.setInstrumentation(true);
+    alg.setStatsLogger(&statsLogger);
+  }
+
+  //
+  // Stop early if any of the requested termination policies says so
+  //
+  CombinedTermination termination(CombinedTermination::kAny);
+  StallTermination stallTermination(config.get("stallGenerations") > 0 ? (int)config.get("stallGenerations") : 1);
+  DiversityTermination diversityTermination(config.get("minDiversity"));
+  ScoreRMSTermination rmsTermination(config.get("minRelativeRMS"));
+  WallClockTermination timeTermination(config.get("maxTime"));
+  EvaluationBudgetTermination evaluationTermination(config.get("maxEvaluations"));
+  if((int)config.get("stallGenerations") > 0) termination.add(&stallTermination);
+  if((double)config.get("minDiversity") > 0) termination.add(&diversityTermination);
+  if((double)config.get("minRelativeRMS") > 0) termination.add(&rmsTermination);
+  if((double)config.get("maxTime") > 0) termination.add(&timeTermination);
+  if((long)config.get("maxEvaluations") > 0) termination.add(&evaluationTermination);
+  alg.setTerminationPolicy(&termination);
+
+  //
+  // Save the state of the optimization periodically if requested
+  //
+  CheckpointWriter *checkpointWriter = 0;
+  std::string checkpointFile = config.get("checkpoint");
+  if(!checkpointFile.empty()) {
+    checkpointWriter = new CheckpointWriter(checkpointFile);
+    alg.setCheckpointWriter(checkpointWriter, config.get("checkpointInterval"));
+  }
 
   //
   // Prepare for making plots
@@ -144,39 +271,42 @@ int main(int argc, char **argv) {
   gSystem->Exec("rm -rf figures");
   gSystem->Exec("mkdir -p figures");
   gStyle->SetOptStat(0); // disables stat box on plots
-  TGraph *gScore = new TGraph();
-  TGraph *gRMS = new TGraph();
-  TCanvas *C_anim = new TCanvas("C_anim", "C_anim");
   hData->SetMarkerStyle(20);
   likelihoodFit->SetLineColor(4);
   likelihoodFit->SetLineStyle(7);
   f->SetLineColor(2);
-  TLegend *L_anim = new TLegend(0.7, 0.7, 0.9, 0.9);
-  L_anim->AddEntry(hData, "Data", "lp");
-  L_anim->AddEntry(likelihoodFit, "Likelihood fit", "l");
-  L_anim->AddEntry(f, "GA fit", "l");
-  TLatex *lt_anim = new TLatex();
+  TLegend *L_fit = new TLegend(0.7, 0.7, 0.9, 0.9);
+  L_fit->AddEntry(hData, "Data", "lp");
+  L_fit->AddEntry(likelihoodFit, "Likelihood fit", "l");
+  L_fit->AddEntry(f, "GA fit", "l");
+  TLatex *lt_fit = new TLatex();
+
+  //
+  // Stream the progress of each generation for offline rendering if tests are requested
+  //
+  TraceWriter traceWriter;
+  if(config.get("runTests")) {
+    traceWriter.open("figures/trace.gatrace", f->GetNpar());
+    alg.setTraceWriter(&traceWriter);
+    TFile dataFile("figures/data.root", "RECREATE");
+    hData->Write("hData");
+    likelihoodFit->Write("likelihoodFit");
+    f->Write("f");
+  }
   
   //
   // Run the GA and the tests if requested
   //
-  alg.initialize(&population);
+  std::string resumeFile = config.get("resume");
+  if(!resumeFile.empty()) {
+    Checkpoint checkpoint;
+    checkpoint.read(resumeFile);
+    alg.initialize(population, checkpoint);
+  }else{
+    alg.initialize(population);
+  }
   do {
     if(config.get("runTests")) {
-      ParametricModel *bestModel = (ParametricModel*)population.getBestFitted();
-      gScore->SetPoint(gScore->GetN(), alg.getCurrentGeneration(), bestModel->getScore());
-      gRMS->SetPoint(gRMS->GetN(), alg.getCurrentGeneration(), population.getScoreRMS()/bestModel->getScore());
-      C_anim->cd();
-      hData->Draw();
-      likelihoodFit->Draw("same");
-      bestModel->getFormula()->SetLineColor(2);
-      bestModel->getFormula()->Draw("same");
-      L_anim->Draw();
-      lt_anim->SetText(xmin + (xmax-xmin)/10., hData->GetMaximum()*0.9, TString::Format("Generation: %d", alg.getCurrentGeneration()));
-      lt_anim->Draw();
-      C_anim->Modified();
-      C_anim->Update();
-      C_anim->SaveAs("figures/C_anim.gif+25");
       std::cout << "\rGeneration: " << alg.getCurrentGeneration();
       std::flush(std::cout);
     }
@@ -184,15 +314,19 @@ int main(int argc, char **argv) {
   if(config.get("runTests")) {
     std::cout << std::endl;
   }
+  delete checkpointWriter;
+  traceWriter.close();
 
   //
   // Display results and make plots
   //
-  ParametricModel *bestModel = (ParametricModel*)population.getBestFitted();
+  ParametricModel *bestModel = (ParametricModel*)population->getBestFitted();
   TF1 *bestFormula = bestModel->getFormula();
 
   std::cout << "Done after " << alg.getCurrentGeneration() << " generations." << std::endl
-	    << "  ==> Best score is: " << bestModel->getScore() << std::endl;
+	    << "  ==> Best score is: " << bestModel->getScore() << std::endl
+	    << "  ==> Scores evaluated: " << population->getCacheMisses()
+	    << ", reused: " << population->getCacheHits() << std::endl;
   
   std::cout << "After GA fit: " << std::endl;
   for(int i=0; i<bestFormula->GetNpar(); i++) {
@@ -210,38 +344,94 @@ int main(int argc, char **argv) {
   likelihoodFit->Draw("same");
   bestFormula->SetLineColor(2);
   bestFormula->Draw("same");
-  L_anim->Draw();
-  lt_anim->SetText(xmin + (xmax-xmin)/10., hData->GetMaximum()*0.9, TString::Format("Generation: %d", alg.getCurrentGeneration()));
-  lt_anim->Draw();
+  L_fit->Draw();
+  lt_fit->SetText(xmin + (xmax-xmin)/10., hData->GetMaximum()*0.9, TString::Format("Generation: %d", alg.getCurrentGeneration()));
+  lt_fit->Draw();
   C_fit->SaveAs("figures/C_fit.png");
   C_fit->SaveAs("figures/C_fit.root");
 
   if(config.get("runTests")) {
-    C_fit->SaveAs("figures/C_anim.gif++300");
-  
-    TCanvas *C_Score = new TCanvas("C_Score", "C_Score");
-    C_Score->cd()->SetLogx();
-    C_Score->cd()->SetLogy();
-    gScore->SetLineColor(4);
-    gScore->SetLineWidth(2);
-    gScore->Draw("AL");
-    C_Score->SaveAs("figures/C_Score.png");
-    C_Score->SaveAs("figures/C_Score.root");
-    
-    TCanvas *C_RMS = new TCanvas("C_RMS", "C_RMS");
-    C_RMS->cd()->SetLogx();
-    C_RMS->cd()->SetLogy();
-    gRMS->SetLineColor(4);
-    gRMS->SetLineWidth(2);
-    gRMS->Draw("AL");
-    C_RMS->SaveAs("figures/C_RMS.png");
-    C_RMS->SaveAs("figures/C_RMS.root");
+    std::cout << "Progress of the optimization written to figures/trace.gatrace, render it with:" << std::endl
+	      << "  ./bin/plotTrace.exe --trace figures/trace.gatrace --data figures/data.root" << std::endl;
   }
   
   return 0;
 }
 
 
+/**
+ * @brief Fits the data with the templated Genetic Algorithm.
+ *
+ * The algorithm is StaticGeneticAlgorithm, composed with the given fitness and the default operators,
+ * which behave as the population of the main algorithm. The fitness is either the compiled gaussian function
+ * (CompiledChi2Fitness) or the interpreted formula (FigureOfMeritFitness). Checkpoints, traces, steady-state
+ * evolution and termination policies are not available with it.
+ *
+ * @param config Configuration of the algorithm.
+ * @param fitness Fitness of the genomes, holding the data.
+ * @param f Formula defining the initial parameters and their limits, which receives the best fitted parameters.
+ * @return Number of generations.
+ */
+template<class Fitness>
+int fitStatic(Config &config, const Fitness *fitness, TF1 *f)
+{
+  typedef CompiledChi2Fitness<Gaussian>::Genome Genome;
+
+  Genome initial;
+  Genome parMin;
+  Genome parMax;
+  for(int p=0; p<Gaussian::kNpar; p++) {
+    initial[p] = f->GetParameter(p);
+    f->GetParLimits(p, parMin[p], parMax[p]);
+  }
+
+  StaticGeneticAlgorithm<Genome, Fitness> alg;
+  alg.setFitness(fitness);
+  alg.setNGenerationsMax(config.get("maxGenerations"));
+  alg.setPopulationSize(config.get("populationSize"));
+  alg.setMutateRate(config.get("mutateRate"));
+  alg.setNThreads(config.get("nThreads"));
+  alg.setMutation(GaussianMutation<Genome>(parMin, parMax, config.get("mutateSize")));
+
+  const Genome &best = alg.optimize(UniformInitializer<Genome>(initial, parMin, parMax));
+  f->SetParameters(best.data());
+
+  std::cout << "Done after " << alg.getCurrentGeneration() << " generations." << std::endl
+	    << "  ==> Best score is: " << alg.getScore() << std::endl
+	    << "  ==> Scores evaluated: " << alg.getNEvaluations() << std::endl;
+
+  return alg.getCurrentGeneration();
+}
+
+/**
+ * @brief Checks that the compiled and the interpreted fitness give the same score to the best fitted parameters.
+ *
+ * Both fitnesses compute the \f$\chi^2/ndf\f$ of the gaussian on the same data, such that their scores should
+ * only differ by rounding.
+ *
+ * @param compiled Fitness evaluating the compiled gaussian function.
+ * @param interpreted Fitness evaluating the interpreted formula, on the same data.
+ * @param f Formula holding the best fitted parameters.
+ * @return true if the scores agree.
+ */
+bool compareStaticScores(const CompiledChi2Fitness<Gaussian> *compiled, const FigureOfMeritFitness<CompiledChi2Fitness<Gaussian>::Genome> *interpreted, const TF1 *f)
+{
+  typedef CompiledChi2Fitness<Gaussian>::Genome Genome;
+
+  Genome best;
+  for(int p=0; p<Gaussian::kNpar; p++) best[p] = f->GetParameter(p);
+  double interpretedScore = interpreted->evaluate(best);
+  double compiledScore = compiled->evaluate(best);
+  bool same = std::fabs(interpretedScore - compiledScore) <= 1e-9*std::fabs(compiledScore);
+
+  std::cout << "Score of the best fitted parameters:" << std::endl
+	    << "  ==> Interpreted formula: " << interpretedScore << std::endl
+	    << "  ==> Compiled function: " << compiledScore << (same ? "" : "  (MISMATCH)") << std::endl;
+
+  return same;
+}
+
+
 /** 
  * @brief Prase command line arguments.
  *
@@ -288,7 +478,67 @@ void parseCommandLine(Config &config, int argc, char **argv)
   parser.add_option("-G", "--populationSize").action("store").dest("populationSize").set_default(500)
     .help("Size of the population to be evolved.");
 
-  /** - @b -t, <b> \-\-runTests </b> Run tests alongside the main algorithm. */
+  /** - @b -j, <b> \-\-nThreads </b> Number of threads used to breed and score the population. */
+  parser.add_option("-j", "--nThreads").action("store").dest("nThreads").set_default(1)
+    .help("Number of threads used to breed and score the population.");
+
+  /** - @b -c, <b> \-\-compiled </b> Use a compiled gaussian function instead of the interpreted formula. */
+  parser.add_option("-c", "--compiled").action("store_true").dest("compiled").set_default(false)
+    .help("Use a compiled gaussian function instead of the interpreted formula.");
+
+  /** - @b -x, <b> \-\-static </b> Use the templated Genetic Algorithm (see StaticGeneticAlgorithm), with the interpreted formula or with the compiled gaussian function if `--compiled` is given. */
+  parser.add_option("-x", "--static").action("store_true").dest("static").set_default(false)
+    .help("Use the templated Genetic Algorithm, with the interpreted formula or with the compiled gaussian function if --compiled is given.");
+
+  /** - @b -C, <b> \-\-cacheSize </b> Number of genomes whose score is remembered across generations (0 to disable). */
+  parser.add_option("-C", "--cacheSize").action("store").dest("cacheSize").set_default(0)
+    .help("Number of genomes whose score is remembered across generations (0 to disable).");
+
+  /** - @b -P, <b> \-\-nProcesses </b> Number of worker processes used to compute the scores (0 to compute them in this process). */
+  parser.add_option("-P", "--nProcesses").action("store").dest("nProcesses").set_default(0)
+    .help("Number of worker processes used to compute the scores (0 to compute them in this process).");
+
+  /** - @b -k, <b> \-\-steadyState </b> Number of offspring replacing the least fitted individuals at each iteration (0 to replace whole generations). */
+  parser.add_option("-k", "--steadyState").action("store").dest("steadyState").set_default(0)
+    .help("Number of offspring replacing the least fitted individuals at each iteration (0 to replace whole generations).");
+
+  /** - @b -L, <b> \-\-statsLog </b> File receiving the time spent in each stage of each generation, as CSV or as JSON lines if it ends with .json (empty to disable). */
+  parser.add_option("-L", "--statsLog").action("store").dest("statsLog").set_default("")
+    .help("File receiving the time spent in each stage of each generation, as CSV or as JSON lines if it ends with .json (empty to disable).");
+
+  /** - @b -I, <b> \-\-stallGenerations </b> Stop if the best score did not improve for this number of generations (0 to disable). */
+  parser.add_option("-I", "--stallGenerations").action("store").dest("stallGenerations").set_default(0)
+    .help("Stop if the best score did not improve for this number of generations (0 to disable).");
+
+  /** - @b -D, <b> \-\-minDiversity </b> Stop if the spread of the parameters, relative to the initial population, falls below this value (0 to disable). */
+  parser.add_option("-D", "--minDiversity").action("store").dest("minDiversity").set_default(0)
+    .help("Stop if the spread of the parameters, relative to the initial population, falls below this value (0 to disable).");
+
+  /** - @b -r, <b> \-\-minRelativeRMS </b> Stop if the RMS of the scores, relative to the best score, falls below this value (0 to disable). */
+  parser.add_option("-r", "--minRelativeRMS").action("store").dest("minRelativeRMS").set_default(0)
+    .help("Stop if the RMS of the scores, relative to the best score, falls below this value (0 to disable).");
+
+  /** - @b -T, <b> \-\-maxTime </b> Stop after this number of seconds (0 to disable). */
+  parser.add_option("-T", "--maxTime").action("store").dest("maxTime").set_default(0)
+    .help("Stop after this number of seconds (0 to disable).");
+
+  /** - @b -E, <b> \-\-maxEvaluations </b> Stop after this number of score evaluations (0 to disable). */
+  parser.add_option("-E", "--maxEvaluations").action("store").dest("maxEvaluations").set_default(0)
+    .help("Stop after this number of score evaluations (0 to disable).");
+
+  /** - @b -K, <b> \-\-checkpoint </b> File receiving the state of the optimization periodically (empty to disable). */
+  parser.add_option("-K", "--checkpoint").action("store").dest("checkpoint").set_default("")
+    .help("File receiving the state of the optimization periodically (empty to disable).");
+
+  /** - @b -i, <b> \-\-checkpointInterval </b> Number of generations between checkpoints. */
+  parser.add_option("-i", "--checkpointInterval").action("store").dest("checkpointInterval").set_default(100)
+    .help("Number of generations between checkpoints.");
+
+  /** - @b -u, <b> \-\-resume </b> Checkpoint file from which the optimization is resumed (empty to start a new one). */
+  parser.add_option("-u", "--resume").action("store").dest("resume").set_default("")
+    .help("Checkpoint file from which the optimization is resumed (empty to start a new one).");
+
+  /** - @b -t, <b> \-\-runTests </b> Run tests alongside the main algorithm: the progress of each generation is written to figures/trace.gatrace (see plotTrace). */
   parser.add_option("-t", "--runTests").action("store_true").dest("runTests").set_default(false)
     .help("Run tests alongside the main algorithm.");
 
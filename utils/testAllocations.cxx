@@ -0,0 +1,221 @@
+/**
+ * @file
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+
+#include <TRandom3.h>
+
+#include "ParametricModelPopulation.h"
+#include "Chi2FitFigureOfMerit.h"
+#include "GeneticAlgorithm.h"
+#include "InstrumentationCounters.h"
+#include "optparse.h"
+
+void parseCommandLine(Config &config, int argc, char **argv);
+
+/**
+ * @defgroup testAllocations Allocation Test
+ *
+ * @brief Test that steady-state generations do not allocate memory.
+ *
+ * @b Objective: all buffers needed to breed and rank a generation are allocated at initialization.
+ * This program replaces the global allocation functions to count heap allocations, and checks that
+ * none happens while evolving a population, for both genome storage modes. It also checks that re-initializing
+ * a population recycles its models (see ModelPool) instead of allocating new ones. If the library is compiled
+ * with the instrumentation counters (see InstrumentationCounters), these already count the allocations.
+ *
+ * @{
+ */
+
+#ifdef GA_INSTRUMENTATION_COUNTERS
+
+/** Returns the number of heap allocations counted so far. */
+static long getNAllocations()
+{
+  return InstrumentationCounters::getAllocations();
+}
+
+#else
+
+/** Number of heap allocations counted so far. */
+static long gNAllocations = 0;
+
+/** Returns the number of heap allocations counted so far. */
+static long getNAllocations()
+{
+  return gNAllocations;
+}
+
+void *operator new(std::size_t size)
+{
+  gNAllocations++;
+  void *ptr = std::malloc(size ? size : 1);
+  if(!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+#endif
+
+/**
+ * @brief Counts the heap allocations made while evolving a population.
+ *
+ * @param storage Genome storage mode of the population.
+ * @param config Test configuration.
+ * @param nReinitialize Filled with the number of heap allocations made by re-initializing the population,
+ * after a first re-initialization.
+ * @return Number of heap allocations made after the warm-up generations.
+ */
+long countAllocations(ParametricModelPopulation::GenomeStorage storage, Config &config, long &nReinitialize)
+{
+
+  // Dataset following a gaussian distribution
+  Chi2FitFigureOfMerit fom;
+  fom.setAcceptThreshold(0); // never accept, such that all generations are run
+  TRandom3 rnd(1234);
+  std::vector<double> x(1);
+  for(int i=0; i<100; i++) {
+    x[0] = -10 + 0.2*i;
+    double y = exp(-0.5*x[0]*x[0]/4.);
+    fom.addData(x, y + rnd.Gaus(0, 0.01), 0.01);
+  }
+
+  TF1 *f = new TF1("f", "gaus", -10, 10);
+  f->SetParLimits(0, 0.001, 2);
+  f->SetParLimits(1, -10, 10);
+  f->SetParLimits(2, 0.001, 10);
+
+  ParametricModelPopulation population;
+  population.setFigureOfMerit(&fom);
+  population.setFormula(f);
+  population.setGenomeStorage(storage);
+  population.setMutateRate(config.get("mutateRate"));
+  population.setNThreads(config.get("nThreads"));
+
+  GeneticAlgorithm alg;
+  alg.setPopulationSize(config.get("populationSize"));
+  alg.setNGenerationsMax(1000000);
+  alg.initialize(&population);
+
+  int nWarmUp = config.get("nWarmUp");
+  for(int i=0; i<nWarmUp; i++) {
+    alg.nextGeneration();
+  }
+
+  int nGenerations = config.get("nGenerations");
+  long nAllocations = getNAllocations();
+  for(int i=0; i<nGenerations; i++) {
+    alg.nextGeneration();
+  }
+  nAllocations = getNAllocations() - nAllocations;
+
+  population.clear();
+  alg.initialize(&population);
+  nReinitialize = getNAllocations();
+  population.clear();
+  alg.initialize(&population);
+  nReinitialize = getNAllocations() - nReinitialize;
+
+  delete f;
+
+  return nAllocations;
+}
+
+/**
+ * @brief Main function
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return 0 if no allocation was counted, 1 otherwise.
+ */
+int main(int argc, char **argv) {
+
+  Config config;
+  parseCommandLine(config, argc, argv);
+
+  long nFlatReinitialize, nClonesReinitialize;
+  long nFlat = countAllocations(ParametricModelPopulation::kFlatBuffer, config, nFlatReinitialize);
+  long nClones = countAllocations(ParametricModelPopulation::kFormulaClones, config, nClonesReinitialize);
+
+  std::cout << "Heap allocations over " << (int)config.get("nGenerations") << " generations:" << std::endl
+	    << "  ==> kFlatBuffer: " << nFlat << std::endl
+	    << "  ==> kFormulaClones: " << nClones << std::endl
+	    << "Heap allocations when re-initializing the population:" << std::endl
+	    << "  ==> kFlatBuffer: " << nFlatReinitialize << std::endl
+	    << "  ==> kFormulaClones: " << nClonesReinitialize << std::endl;
+
+  if(nFlat || nClones || nFlatReinitialize || nClonesReinitialize) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+  return 0;
+}
+
+/**
+ * @brief Prase command line arguments.
+ *
+ * @param config Configuration to parse into.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ *
+ * #### Configuration details:
+ */
+void parseCommandLine(Config &config, int argc, char **argv)
+{
+
+  optparse::OptionParser parser = optparse::OptionParser().description("Allocation Test");
+
+  /** - @b -N, <b> \-\-populationSize </b> Size of the population to be evolved. */
+  parser.add_option("-N", "--populationSize").action("store").dest("populationSize").set_default(500)
+    .help("Size of the population to be evolved.");
+
+  /** - @b -w, <b> \-\-nWarmUp </b> Number of generations evolved before counting allocations. */
+  parser.add_option("-w", "--nWarmUp").action("store").dest("nWarmUp").set_default(2)
+    .help("Number of generations evolved before counting allocations.");
+
+  /** - @b -g, <b> \-\-nGenerations </b> Number of generations evolved while counting allocations. */
+  parser.add_option("-g", "--nGenerations").action("store").dest("nGenerations").set_default(50)
+    .help("Number of generations evolved while counting allocations.");
+
+  /** - @b -R, <b> \-\-mutateRate </b> Rate at which models are subjected to mutation. */
+  parser.add_option("-R", "--mutateRate").action("store").dest("mutateRate").set_default(0.01)
+    .help("Rate at which models are subjected to mutation.");
+
+  /** - @b -j, <b> \-\-nThreads </b> Number of threads used to compute the scores. */
+  parser.add_option("-j", "--nThreads").action("store").dest("nThreads").set_default(1)
+    .help("Number of threads used to compute the scores.");
+
+  config = parser.parse_args(argc, argv);
+}
+
+/** @} */
@@ -0,0 +1,235 @@
+/**
+ * @file
+ */
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "IModel.h"
+#include "IFigureOfMerit.h"
+#include "MultiProcessFigureOfMerit.h"
+#include "optparse.h"
+
+void parseCommandLine(Config &config, int argc, char **argv);
+
+/**
+ * @defgroup testMultiProcess Worker Processes Test
+ *
+ * @brief Test the recovery of MultiProcessFigureOfMerit from failing workers.
+ *
+ * @b Objective: the worker processes run on the local machine, such that their failures can be provoked.
+ * This program evaluates models with a figure of merit whose workers crash or hang on given genomes, and checks
+ * that the scores are those of a direct evaluation after a worker crashed, after a worker timed out, and after
+ * an evaluation that failed while other workers were still evaluating their batch.
+ *
+ * @{
+ */
+
+/** Genome value making the first worker evaluating it crash. */
+static const double kCrashOnce = -1;
+
+/** Genome value making the first worker evaluating it hang. */
+static const double kHangOnce = -2;
+
+/** Genome value making every worker evaluating it crash. */
+static const double kCrashAlways = -3;
+
+/**
+ * @brief Model holding a genome of two values.
+ */
+class PairModel : public IModel {
+
+public:
+
+  /** Constructor */
+  PairModel(double a=0, double b=0) { m_genome[0] = a; m_genome[1] = b; }
+
+  /** Destructor */
+  ~PairModel() {}
+
+  /** Returns the size of the genome. */
+  int getGenomeSize() const { return 2; }
+
+  /** Returns the genome. */
+  const double *getGenome() const { return m_genome; }
+
+  /** Sets the genome. */
+  void setGenome(const double *genome) { m_genome[0] = genome[0]; m_genome[1] = genome[1]; }
+
+private:
+
+  double m_genome[2]; //!< Stores the genome.
+};
+
+/**
+ * @brief Figure of merit whose evaluation fails on given genomes.
+ *
+ * The number of failures already provoked is shared by the worker processes through an anonymous shared
+ * mapping, created before the workers are forked.
+ */
+class FailingFigureOfMerit : public IFigureOfMerit {
+
+public:
+
+  /** Constructor */
+  FailingFigureOfMerit(std::atomic<int> *nFailures, double delay) : m_nFailures(nFailures), m_delay(delay) {}
+
+  /** Compute the score of a model, possibly failing. */
+  double evaluate(IModel *model) const
+  {
+    const double *genome = model->getGenome();
+    if(genome[0] == kCrashAlways || (genome[0] == kCrashOnce && m_nFailures[0]++ == 0)) {
+      kill(getpid(), SIGKILL);
+    }
+    if(genome[0] == kHangOnce && m_nFailures[1]++ == 0) {
+      pause();
+    }
+    if(m_delay > 0) usleep((useconds_t)(m_delay*1e6));
+    return score(genome);
+  }
+
+  /** Returns the expected score of a genome. */
+  static double score(const double *genome) { return genome[0]*genome[1] + genome[1]; }
+
+private:
+
+  std::atomic<int> *m_nFailures; //!< Points to the shared numbers of crashes and hangs provoked.
+  double m_delay; //!< Stores the duration of an evaluation in seconds.
+};
+
+/**
+ * @brief Evaluates models and compares their scores to the expected ones.
+ *
+ * @param fom Figure of merit distributing the evaluations.
+ * @param models Models to be evaluated.
+ * @param name Name of the check.
+ * @return true if all scores are as expected.
+ */
+bool checkScores(MultiProcessFigureOfMerit &fom, std::vector<PairModel> &models, const char *name)
+{
+  std::vector<IModel*> pointers;
+  for(unsigned int i=0; i<models.size(); i++) pointers.push_back(&models[i]);
+  std::vector<double> scores(models.size());
+  fom.evaluateBatch(pointers.data(), pointers.size(), scores.data());
+
+  int nWrong = 0;
+  for(unsigned int i=0; i<models.size(); i++) {
+    if(scores[i] != FailingFigureOfMerit::score(models[i].getGenome())) nWrong++;
+  }
+  std::cout << "  ==> " << name << ": " << nWrong << " wrong scores" << std::endl;
+  return nWrong == 0;
+}
+
+/**
+ * @brief Main function
+ *
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return 0 if all checks passed, 1 otherwise.
+ */
+int main(int argc, char **argv) {
+
+  Config config;
+  parseCommandLine(config, argc, argv);
+
+  void *shared = mmap(0, 2*sizeof(std::atomic<int>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if(shared == MAP_FAILED) {
+    std::cout << "FAILED: cannot create the shared counters" << std::endl;
+    return 1;
+  }
+  std::atomic<int> *nFailures = new(shared) std::atomic<int>[2];
+  nFailures[0] = 0;
+  nFailures[1] = 0;
+
+  FailingFigureOfMerit failing(nFailures, config.get("delay"));
+  MultiProcessFigureOfMerit fom(&failing, config.get("nWorkers"));
+  fom.setTimeout(config.get("timeout"));
+  fom.setBatchSize(config.get("batchSize"));
+  fom.setMaxRetries(2);
+  PairModel prototype;
+  fom.startWorkers(&prototype);
+
+  int n = config.get("nModels");
+  std::vector<PairModel> models;
+  for(int i=0; i<n; i++) models.push_back(PairModel(i, 0.5*i));
+
+  bool ok = true;
+  std::cout << "Scores computed by " << (int)config.get("nWorkers") << " worker processes:" << std::endl;
+  ok = checkScores(fom, models, "healthy workers") && ok;
+
+  models[n/2] = PairModel(kCrashOnce, 3);
+  ok = checkScores(fom, models, "crashed worker") && ok;
+
+  models[n/2] = PairModel(kHangOnce, 3);
+  ok = checkScores(fom, models, "timed out worker") && ok;
+
+  models[0] = PairModel(kCrashAlways, 3);
+  bool failed = false;
+  try {
+    checkScores(fom, models, "failing batch");
+  }catch(std::runtime_error &error) {
+    failed = true;
+    std::cout << "  ==> failing batch: " << error.what() << std::endl;
+  }
+  ok = failed && ok;
+
+  models[0] = PairModel(0, 3);
+  ok = checkScores(fom, models, "after a failed evaluation") && ok;
+
+  fom.stopWorkers();
+  munmap(shared, 2*sizeof(std::atomic<int>));
+
+  if(!ok) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+  return 0;
+}
+
+/**
+ * @brief Prase command line arguments.
+ *
+ * @param config Configuration to parse into.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ *
+ * #### Configuration details:
+ */
+void parseCommandLine(Config &config, int argc, char **argv)
+{
+
+  optparse::OptionParser parser = optparse::OptionParser().description("Worker Processes Test");
+
+  /** - @b -n, <b> \-\-nModels </b> Number of models evaluated at each check. */
+  parser.add_option("-n", "--nModels").action("store").dest("nModels").set_default(40)
+    .help("Number of models evaluated at each check.");
+
+  /** - @b -p, <b> \-\-nWorkers </b> Number of worker processes. */
+  parser.add_option("-p", "--nWorkers").action("store").dest("nWorkers").set_default(4)
+    .help("Number of worker processes.");
+
+  /** - @b -b, <b> \-\-batchSize </b> Number of models sent to a worker at once. */
+  parser.add_option("-b", "--batchSize").action("store").dest("batchSize").set_default(2)
+    .help("Number of models sent to a worker at once.");
+
+  /** - @b -t, <b> \-\-timeout </b> Time in seconds after which a worker is replaced. */
+  parser.add_option("-t", "--timeout").action("store").dest("timeout").set_default(1)
+    .help("Time in seconds after which a worker is replaced.");
+
+  /** - @b -d, <b> \-\-delay </b> Duration of an evaluation in seconds. */
+  parser.add_option("-d", "--delay").action("store").dest("delay").set_default(0.01)
+    .help("Duration of an evaluation in seconds.");
+
+  config = parser.parse_args(argc, argv);
+}
+
+/** @} */